@@ -0,0 +1,46 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+
+std::vector<Bench::SBenchmark>& Bench::registry() {
+    static std::vector<SBenchmark> benchmarks;
+    return benchmarks;
+}
+
+void Bench::report(const std::string& label, double nsPerOp, const std::string& extra) {
+    std::printf("  %-48s %10.2f ns/op%s%s\n", label.c_str(), nsPerOp, extra.empty() ? "" : "  ", extra.c_str());
+    // runs can take a while, show progress even when piped
+    std::fflush(stdout);
+}
+
+void Bench::note(const std::string& text) {
+    std::printf("  %s\n", text.c_str());
+}
+
+std::vector<size_t> Bench::threadCounts() {
+    const size_t        CORES = std::max(1U, std::thread::hardware_concurrency());
+
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < CORES; n *= 2) {
+        counts.emplace_back(n);
+    }
+
+    counts.emplace_back(CORES);
+    return counts;
+}
+
+int main(int argc, char** argv) {
+    const std::string_view FILTER = argc > 1 ? argv[1] : "";
+
+    for (const auto& bench : Bench::registry()) {
+        if (!std::string_view{bench.name}.contains(FILTER))
+            continue;
+
+        std::printf("%s\n", bench.name);
+        bench.fn();
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    A minimal microbenchmark harness, built with -DHYPRUTILS_BUILD_BENCHMARKS=ON.
+
+    Every BENCHMARK(name) registers itself, the hyprutils_bench binary runs the ones whose name
+    contains its first argument, or all of them. Results are printed, nothing is asserted:
+    the numbers only mean something next to each other, from the same run on the same machine.
+*/
+
+namespace Bench {
+    using Clock = std::chrono::steady_clock;
+
+    struct SBenchmark {
+        const char* name = nullptr;
+        void (*fn)()     = nullptr;
+    };
+
+    std::vector<SBenchmark>& registry();
+
+    struct SRegister {
+        SRegister(const char* name, void (*fn)()) {
+            registry().emplace_back(SBenchmark{.name = name, .fn = fn});
+        }
+    };
+
+    /* prints one result line, label padded so the columns line up */
+    void report(const std::string& label, double nsPerOp, const std::string& extra = "");
+
+    /* prints a line of context, e.g. sizes, along with the results */
+    void note(const std::string& text);
+
+    /* keeps the compiler from dropping a computation whose result is otherwise unused */
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /* runs fn(i) for i in [0, iterations), returns the ns per call */
+    template <typename Fn>
+    double timeOps(size_t iterations, Fn&& fn) {
+        const auto START = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn(i);
+        }
+
+        return std::chrono::duration<double, std::nano>(Clock::now() - START).count() / iterations;
+    }
+
+    /*
+        runs fn(thread, i) for i in [0, iterations) on threads threads at once,
+        returns the wall time per call of one thread. Flat as threads go up means it scales.
+    */
+    template <typename Fn>
+    double timeOpsThreaded(size_t threads, size_t iterations, Fn&& fn) {
+        std::vector<std::thread> workers;
+        std::atomic<size_t>      ready = 0;
+        std::atomic<bool>        go    = false;
+
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                ready++;
+                while (!go) {
+                    std::this_thread::yield();
+                }
+
+                for (size_t i = 0; i < iterations; ++i) {
+                    fn(t, i);
+                }
+            });
+        }
+
+        while (ready < threads) {
+            std::this_thread::yield();
+        }
+
+        const auto START = Clock::now();
+        go               = true;
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        return std::chrono::duration<double, std::nano>(Clock::now() - START).count() / iterations;
+    }
+
+    /* thread counts to try: 1, 2, 4 ... up to the core count */
+    std::vector<size_t> threadCounts();
+}
+
+#define BENCHMARK(name)                                                                                                                                                            \
+    static void            name();                                                                                                                                                 \
+    static Bench::SRegister name##Register(#name, name);                                                                                                                           \
+    static void            name()
@@ -0,0 +1,49 @@
+#include "../Bench.hpp"
+
+#include <hyprutils/memory/Atomic.hpp>
+
+#include <mutex>
+#include <string>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    // what every copy and reset used to do: the counts behind a recursive_mutex
+    struct SMutexCounts {
+        std::recursive_mutex mutex;
+        unsigned int         strong = 1;
+
+        void                 inc() {
+            std::lock_guard<std::recursive_mutex> lg(mutex);
+            strong++;
+        }
+
+        void dec() {
+            std::lock_guard<std::recursive_mutex> lg(mutex);
+            strong--;
+        }
+    };
+}
+
+static constexpr size_t ITERATIONS = 1000000;
+
+// every thread copies and drops the same pointer, so they all hit the one control block
+BENCHMARK(atomicSharedPointerContention) {
+    auto         shared = makeAtomicShared<int>(1);
+    SMutexCounts counts;
+
+    for (const auto THREADS : Bench::threadCounts()) {
+        const auto LOCKFREE = Bench::timeOpsThreaded(THREADS, ITERATIONS, [&](size_t, size_t) {
+            CAtomicSharedPointer<int> copy = shared;
+            Bench::doNotOptimize(copy);
+        });
+
+        const auto MUTEX = Bench::timeOpsThreaded(THREADS, ITERATIONS, [&](size_t, size_t) {
+            counts.inc();
+            counts.dec();
+        });
+
+        Bench::report("copy + drop, " + std::to_string(THREADS) + " threads, atomic counts", LOCKFREE);
+        Bench::report("copy + drop, " + std::to_string(THREADS) + " threads, recursive_mutex", MUTEX);
+    }
+}
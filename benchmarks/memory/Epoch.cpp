@@ -0,0 +1,37 @@
+#include "../Bench.hpp"
+
+#include <hyprutils/memory/Atomic.hpp>
+#include <hyprutils/memory/Epoch.hpp>
+
+#include <string>
+
+using namespace Hyprutils::Memory;
+
+static constexpr size_t ITERATIONS = 1000000;
+
+namespace {
+    struct SConfig {
+        int value = 1;
+    };
+}
+
+// readers only looking at a shared object: locking writes its refcount, peeking only the reader's own epoch
+BENCHMARK(atomicWeakReadScalability) {
+    auto                        config = makeAtomicShared<SConfig>();
+    CAtomicWeakPointer<SConfig> weak   = config;
+
+    for (const auto THREADS : Bench::threadCounts()) {
+        const auto LOCKED = Bench::timeOpsThreaded(THREADS, ITERATIONS, [&](size_t, size_t) {
+            auto locked = weak.lock();
+            Bench::doNotOptimize(locked->value);
+        });
+
+        const auto PEEKED = Bench::timeOpsThreaded(THREADS, ITERATIONS, [&](size_t, size_t) {
+            CEpochGuard guard;
+            Bench::doNotOptimize(weak.peek(guard)->value);
+        });
+
+        Bench::report("lock + read, " + std::to_string(THREADS) + " threads", LOCKED);
+        Bench::report("guard + peek + read, " + std::to_string(THREADS) + " threads", PEEKED);
+    }
+}
@@ -0,0 +1,50 @@
+#include "../Bench.hpp"
+
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+#include <hyprutils/memory/ControlBlockPool.hpp>
+
+#include <string>
+#include <vector>
+
+#if __has_include(<malloc.h>)
+#include <malloc.h>
+#endif
+
+using namespace Hyprutils::Memory;
+
+static constexpr size_t OBJECTS = 1000000;
+
+// heap in use, malloc's own chunk overhead included, as that is what the objects really cost
+static size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// makes OBJECTS shared ints with make, keeps them alive, reports the time and bytes per object
+template <typename Make>
+static void measure(const std::string& label, Make&& make) {
+    std::vector<CSharedPointer<int>> objects;
+    objects.reserve(OBJECTS);
+
+    const auto BEFORE = heapInUse();
+    const auto NS     = Bench::timeOps(OBJECTS, [&](size_t i) { objects.emplace_back(make(i)); });
+    const auto BYTES  = (heapInUse() - BEFORE + (OBJECTS / 2)) / OBJECTS;
+
+    Bench::report(label, NS, BEFORE ? std::to_string(BYTES) + " bytes per live object" : "no heap stats on this libc");
+}
+
+BENCHMARK(sharedPointerFootprint) {
+    Bench::note("sizeof(impl_base) is " + std::to_string(sizeof(Impl_::impl_base)) + ", sizeof(CWeakPointer<int>) " + std::to_string(sizeof(CWeakPointer<int>)));
+
+    measure("makeShared<int>", [](size_t i) { return makeShared<int>(sc<int>(i)); });
+    measure("CSharedPointer<int>(new int)", [](size_t i) { return CSharedPointer<int>(new int(sc<int>(i))); });
+
+    ControlBlockPool::setThreadMode(POOL_MODE_ENABLED);
+    measure("makeShared<int>, pooled", [](size_t i) { return makeShared<int>(sc<int>(i)); });
+    ControlBlockPool::trim();
+    ControlBlockPool::setThreadMode(POOL_MODE_INHERIT);
+}
@@ -0,0 +1,67 @@
+#include "../Bench.hpp"
+
+#include <hyprutils/memory/ObjectPool.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/UniquePtr.hpp>
+
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+static constexpr size_t ITERATIONS = 1000000;
+static constexpr size_t BATCH      = 1000;
+
+namespace {
+    // about the size of a listener or an animated variable
+    struct SObject {
+        int    value = 0;
+        double payload[7]{};
+    };
+}
+
+// make and drop right away: what the free lists of either side are best at
+template <typename Make>
+static double churn(Make&& make) {
+    return Bench::timeOps(ITERATIONS, [&](size_t i) {
+        auto object = make(sc<int>(i));
+        Bench::doNotOptimize(object);
+    });
+}
+
+// keep a batch alive and walk it, as when iterating listeners, then drop it. Per object
+template <typename Make>
+static double batch(Make&& make) {
+    using Ptr = decltype(make(0));
+    std::vector<Ptr> objects;
+    objects.reserve(BATCH);
+
+    const auto NS = Bench::timeOps(ITERATIONS / BATCH, [&](size_t) {
+        for (size_t i = 0; i < BATCH; ++i) {
+            objects.emplace_back(make(sc<int>(i)));
+        }
+
+        int sum = 0;
+        for (const auto& object : objects) {
+            sum += object->value;
+        }
+
+        Bench::doNotOptimize(sum);
+        objects.clear();
+    });
+
+    return NS / BATCH;
+}
+
+BENCHMARK(objectPoolThroughput) {
+    CObjectPool<SObject> pool;
+
+    Bench::report("make + drop, makeShared", churn([](int v) { return makeShared<SObject>(v); }));
+    Bench::report("make + drop, pool.makeShared", churn([&](int v) { return pool.makeShared(v); }));
+    Bench::report("make + drop, makeUnique", churn([](int v) { return makeUnique<SObject>(v); }));
+    Bench::report("make + drop, pool.makeUnique", churn([&](int v) { return pool.makeUnique(v); }));
+
+    Bench::report("batch of 1000 + walk, makeShared", batch([](int v) { return makeShared<SObject>(v); }));
+    Bench::report("batch of 1000 + walk, pool.makeShared", batch([&](int v) { return pool.makeShared(v); }));
+    Bench::report("batch of 1000 + walk, makeUnique", batch([](int v) { return makeUnique<SObject>(v); }));
+    Bench::report("batch of 1000 + walk, pool.makeUnique", batch([&](int v) { return pool.makeUnique(v); }));
+}
@@ -0,0 +1,63 @@
+#include "../Bench.hpp"
+
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/WeakMap.hpp>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    struct SKey {
+        int id = 0;
+    };
+}
+
+// sweeping by hand is O(n) per insert, keep the op count such that every size finishes in about the same time
+static size_t opsFor(size_t size) {
+    return std::max<size_t>(100, 10000000 / size);
+}
+
+/*
+    a cache with churn: filled with size keys, then every op replaces one of them, so the map always holds
+    size live entries plus whatever expired and was not evicted yet. Returns the ns per op.
+*/
+template <typename Fill, typename Insert>
+static double churn(size_t size, size_t ops, Fill&& fill, Insert&& insert) {
+    std::vector<CSharedPointer<SKey>> keys;
+    keys.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        keys.emplace_back(makeShared<SKey>(sc<int>(i)));
+        fill(keys.back());
+    }
+
+    return Bench::timeOps(ops, [&](size_t i) {
+        auto& key = keys[i % size];
+        key       = makeShared<SKey>(sc<int>(i));
+        insert(key);
+    });
+}
+
+BENCHMARK(weakMapChurn) {
+    for (size_t size = 10000; size <= 1000000; size *= 10) {
+        const auto OPS = opsFor(size);
+
+        CWeakMap<SKey, int> weakMap;
+        const auto          insertWeak = [&](const CSharedPointer<SKey>& key) { weakMap.emplace(key, key->id); };
+        const auto          WEAKMAP    = churn(size, OPS, insertWeak, insertWeak);
+
+        // the pattern CWeakMap replaces: an unordered_map swept with erase_if on every insert
+        std::unordered_map<CWeakPointer<SKey>, int> manual;
+        const auto                                  fillManual = [&](const CSharedPointer<SKey>& key) { manual.emplace(key, key->id); };
+        const auto                                  MANUAL     = churn(size, OPS, fillManual, [&](const CSharedPointer<SKey>& key) {
+            std::erase_if(manual, [](const auto& entry) { return !entry.first; });
+            manual.emplace(key, key->id);
+        });
+
+        Bench::report("replace a key, " + std::to_string(size) + " entries, CWeakMap", WEAKMAP, std::to_string(weakMap.size()) + " entries left");
+        Bench::report("replace a key, " + std::to_string(size) + " entries, manual sweep", MANUAL, std::to_string(manual.size()) + " entries left");
+    }
+}
@@ -0,0 +1,105 @@
+#include "../Bench.hpp"
+
+#include <hyprutils/signal/Signal.hpp>
+#include <hyprutils/signal/Listener.hpp>
+#include <hyprutils/memory/Casts.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace Hyprutils::Signal;
+using namespace Hyprutils::Memory;
+
+static constexpr size_t EMITS = 1000000;
+
+// cost of one emit as the listener count goes up, the per-listener part is the handler call
+BENCHMARK(signalEmit) {
+    for (const size_t LISTENERS : {0, 1, 4, 16, 64, 256}) {
+        CSignalT<int>                    signal;
+        std::vector<CHyprSignalListener> listeners;
+        int                              sum = 0;
+
+        for (size_t i = 0; i < LISTENERS; ++i) {
+            listeners.emplace_back(signal.listen([&sum](int v) { sum += v; }));
+        }
+
+        const auto NS = Bench::timeOps(EMITS / std::max<size_t>(LISTENERS, 1), [&](size_t i) { signal.emit(sc<int>(i)); });
+
+        Bench::doNotOptimize(sum);
+        Bench::report("emit, " + std::to_string(LISTENERS) + " listeners", NS);
+    }
+}
+
+namespace {
+    struct IHandler {
+        virtual ~IHandler()      = default;
+        virtual void call(int v) = 0;
+    };
+
+    struct CHandler : public IHandler {
+        int  sum = 0;
+
+        void call(int v) override {
+            sum += v;
+        }
+    };
+}
+
+// one listener. A whole emit with the typed listener, next to just the dispatch it used to take, and a plain virtual call
+BENCHMARK(signalListenerDispatch) {
+    int           sum = 0;
+
+    CSignalT<int> signal;
+    auto          listener = signal.listen([&sum](int v) { sum += v; });
+    Bench::report("emit, CSignalT::listen", Bench::timeOps(EMITS, [&](size_t i) { signal.emit(sc<int>(i)); }));
+
+    CSignalT<int> staticSignal;
+    staticSignal.listenStatic([&sum](int v) { sum += v; });
+    Bench::report("emit, CSignalT::listenStatic", Bench::timeOps(EMITS, [&](size_t i) { staticSignal.emit(sc<int>(i)); }));
+
+    // what listen() used to store: the user's std::function, wrapped into one taking the args packed up in a tuple
+    std::function<void(int)>   inner = [&sum](int v) { sum += v; };
+    std::function<void(void*)> outer = [inner](void* args) { std::apply(inner, *sc<std::tuple<int>*>(args)); };
+    const auto                 WRAPPED = Bench::timeOps(EMITS, [&](size_t i) {
+        std::tuple<int> args{sc<int>(i)};
+        outer(&args);
+    });
+    Bench::report("dispatch only, the old double std::function", WRAPPED);
+
+    // volatile, or the call gets devirtualized
+    CHandler           handler;
+    IHandler* volatile virt = &handler;
+    Bench::report("dispatch only, virtual call", Bench::timeOps(EMITS, [&](size_t i) { virt->call(sc<int>(i)); }));
+
+    Bench::doNotOptimize(sum + handler.sum);
+}
+
+// per listen(): registering n listeners should scale linearly, also while others come and go
+BENCHMARK(signalListenScaling) {
+    // the first listener of a type pays for one-off setup, keep that out of the smallest count
+    {
+        CSignalT<int> warmup;
+        auto          listener = warmup.listen([](int) {});
+    }
+
+    for (size_t count = 10; count <= 100000; count *= 10) {
+        CSignalT<int>                    signal;
+        std::vector<CHyprSignalListener> listeners;
+        listeners.reserve(count);
+
+        const auto REGISTER = Bench::timeOps(count, [&](size_t) { listeners.emplace_back(signal.listen([](int) {})); });
+
+        // attach and detach with count listeners alive, every other listener registered goes stale right away
+        const auto CHURN = Bench::timeOps(count, [&](size_t i) {
+            auto listener = signal.listen([](int) {});
+            if (i % 2 == 0)
+                listeners[i] = std::move(listener);
+        });
+
+        Bench::report("listen, " + std::to_string(count) + " listeners", REGISTER);
+        Bench::report("listen + drop, " + std::to_string(count) + " alive", CHURN);
+    }
+}
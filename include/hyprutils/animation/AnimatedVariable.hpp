@@ -3,6 +3,7 @@
 #include "AnimationConfig.hpp"
 #include "../memory/WeakPtr.hpp"
 #include "../memory/SharedPtr.hpp"
+#include "../memory/BorrowedPtr.hpp"
 #include "../signal/Signal.hpp"
 #include "AnimationManager.hpp"
 
@@ -19,7 +20,8 @@ namespace Hyprutils {
         /* A base class for animated variables. */
         class CBaseAnimatedVariable {
           public:
-            using CallbackFun = std::function<void(Memory::CWeakPointer<CBaseAnimatedVariable> thisptr)>;
+            /* thisptr is borrowed from the variable, a callback taking a CWeakPointer still works but takes a ref */
+            using CallbackFun = std::function<void(Memory::CBorrowedPointer<CBaseAnimatedVariable> thisptr)>;
 
             struct SCurveStepResult {
                 float value    = 1.f;
@@ -49,7 +51,8 @@ namespace Hyprutils {
 
             //
             void setConfig(Memory::CSharedPointer<SAnimationPropertyConfig> pConfig) {
-                m_pConfig = pConfig;
+                m_pConfig          = pConfig;
+                m_iCurveGeneration = 0;
             }
 
             Memory::CWeakPointer<SAnimationPropertyConfig> getConfig() const {
@@ -112,12 +115,31 @@ namespace Hyprutils {
 
             bool                                                              m_bIsConnectedToActive = false;
             bool                                                              m_bIsBeingAnimated     = false;
+            // where m_pSelf is in m_vActiveAnimatedVariables, while connected
+            size_t                                                            m_iActiveIndex = 0;
+            // whether applyCurveStep() does anything, i.e. the value type can be interpolated
+            bool                                                              m_bInterpolatable = false;
 
             Memory::CWeakPointer<CBaseAnimatedVariable>                       m_pSelf;
 
             Memory::CWeakPointer<CAnimationManager::SAnimationManagerSignals> m_pSignals;
 
+            /* warps if there is nothing left to animate, i.e. the value is at the goal or the variable is disabled,
+               like update() does first. Returns whether it did. Used by CAnimationManager::updateActive() */
+            virtual bool warpIfSettled() {
+                return false;
+            }
+
+            /* moves the value to where the step puts it, or warps once finished. Used by CAnimationManager::updateActive() */
+            virtual void applyCurveStep(const SCurveStepResult& step) {
+                ;
+            }
+
           private:
+            /* advances the spring curve up to now */
+            SCurveStepResult                               springStep(const SSpringCurve& spring, std::chrono::steady_clock::time_point now);
+            /* looks the curve up again, if the config or the curves of the manager changed since */
+            void                                           resolveCurve() const;
             void                                           resetSpringState(bool preserveVelocity, float velocityScale);
             std::string_view                               springNameFromSpec(const std::string& spec) const;
 
@@ -137,6 +159,11 @@ namespace Hyprutils {
             CallbackFun                                    m_fEndCallback;
             CallbackFun                                    m_fBeginCallback;
             CallbackFun                                    m_fUpdateCallback;
+
+            // the curve of the config, one of them is set once resolved. Valid while m_iCurveGeneration matches the manager's
+            mutable Memory::CSharedPointer<CBezierCurve> m_pBezier;
+            mutable Memory::CSharedPointer<SSpringCurve> m_pSpring;
+            mutable uint32_t                             m_iCurveGeneration = 0;
         };
 
         /* This concept represents the minimum requirement for a type to be used with CGenericAnimatedVariable */
@@ -162,7 +189,9 @@ namespace Hyprutils {
         template <AnimatedType VarType, class AnimationContext>
         class CGenericAnimatedVariable : public CBaseAnimatedVariable {
           public:
-            CGenericAnimatedVariable() = default;
+            CGenericAnimatedVariable() {
+                m_bInterpolatable = AnimableType<VarType>;
+            }
 
             /* Deprecated: use create2 */
             void create(const int typeInfo, CAnimationManager* pAnimationManager, Memory::CSharedPointer<CGenericAnimatedVariable<VarType, AnimationContext>> pSelf,
@@ -279,22 +308,42 @@ namespace Hyprutils {
                 }
 
                 const auto STEP = getCurveStep();
-                if (STEP.finished) {
+                stepTo(STEP);
+
+                return STEP;
+            }
+
+            AnimationContext m_Context;
+
+          protected:
+            virtual bool warpIfSettled() {
+                if (!(m_Value == m_Goal) && enabled())
+                    return false;
+
+                warp(true, false);
+                return true;
+            }
+
+            virtual void applyCurveStep(const SCurveStepResult& step) {
+                if constexpr (AnimableType<VarType>)
+                    stepTo(step);
+            }
+
+          private:
+            template <class T = VarType>
+                requires AnimableType<T>
+            void stepTo(const SCurveStepResult& step) {
+                if (step.finished) {
                     warp(true, false);
-                    return STEP;
+                    return;
                 }
 
                 const auto DELTA = m_Goal - m_Begun;
-                m_Value          = m_Begun + (DELTA * STEP.value);
+                m_Value          = m_Begun + (DELTA * step.value);
 
                 onUpdate();
-
-                return STEP;
             }
 
-            AnimationContext m_Context;
-
-          private:
             VarType m_Value{};
             VarType m_Goal{};
             VarType m_Begun{};
@@ -3,7 +3,9 @@
 #include "./BezierCurve.hpp"
 #include "../math/Vector2D.hpp"
 #include "../memory/WeakPtr.hpp"
+#include "../memory/UniquePtr.hpp"
 #include "../signal/Signal.hpp"
+#include "../signal/StaticSignal.hpp"
 
 #include <cstdint>
 #include <unordered_map>
@@ -27,6 +29,10 @@ namespace Hyprutils {
             CAnimationManager();
             virtual ~CAnimationManager() = default;
 
+            /* Calls update() on every active variable whose value type supports it, in one batch: one timestamp,
+               curves looked up once per frame, and bezier progress computed in a single pass over plain arrays.
+               Other variables are left to the caller. Call tickDone() after, as usual. */
+            void                                                                         updateActive();
             void                                                                         tickDone();
             void                                                                         rotateActive();
             bool                                                                         shouldTickForNext();
@@ -47,6 +53,8 @@ namespace Hyprutils {
             const std::unordered_map<std::string, Memory::CSharedPointer<CBezierCurve>>& getAllBeziers();
             const std::unordered_map<std::string, Memory::CSharedPointer<SSpringCurve>>& getAllSprings();
 
+            /* for observers only, emitted once a variable was added to, or removed from, the active variables.
+               Variables dropped by rotateActive() leave silently */
             struct SAnimationManagerSignals {
                 Signal::CSignalT<Memory::CWeakPointer<CBaseAnimatedVariable>> connect;
                 Signal::CSignalT<Memory::CWeakPointer<CBaseAnimatedVariable>> disconnect;
@@ -54,21 +62,59 @@ namespace Hyprutils {
 
             Memory::CWeakPointer<SAnimationManagerSignals>           getSignals() const;
 
+            /* unordered. Every variable in here knows its index, see CBaseAnimatedVariable::m_iActiveIndex */
             std::vector<Memory::CWeakPointer<CBaseAnimatedVariable>> m_vActiveAnimatedVariables;
 
           private:
+            // O(1), the handlers of m_activeSignals
+            void                                                                  onConnect(CBaseAnimatedVariable* animVar);
+            void                                                                  onDisconnect(CBaseAnimatedVariable* animVar);
+            // variables cache their curve, this makes them look it up again
+            void                                                                  curvesChanged();
+
             std::unordered_map<std::string, Memory::CSharedPointer<CBezierCurve>> m_mBezierCurves;
             std::unordered_map<std::string, Memory::CSharedPointer<SSpringCurve>> m_mSpringCurves;
 
             bool                                                                  m_bTickScheduled = false;
-
-            struct SAnimVarListeners {
-                Signal::CHyprSignalListener connect;
-                Signal::CHyprSignalListener disconnect;
+            // never 0, which variables use for no curve resolved yet
+            uint32_t                                                              m_iCurveGeneration = 1;
+
+            Memory::CUniquePointer<SAnimationManagerSignals>                      m_events;
+
+            // emitted by the variables. Nobody else listens, so an emit is a direct call; the observers get m_events from the handlers
+            struct SActiveSignals {
+                SActiveSignals(CAnimationManager* manager) : connect(manager), disconnect(manager) {
+                    ;
+                }
+
+                Signal::CStaticSignalT<CAnimationManager, &CAnimationManager::onConnect>    connect;
+                Signal::CStaticSignalT<CAnimationManager, &CAnimationManager::onDisconnect> disconnect;
+            } m_activeSignals{this};
+
+            // a variable in the batch, by where it was in m_vActiveAnimatedVariables. Checked against the list before use,
+            // as callbacks may move or drop it
+            struct SBatchEntry {
+                uint32_t               index = 0;
+                CBaseAnimatedVariable* var   = nullptr;
+                int64_t                begin = 0;
             };
 
-            Memory::CUniquePointer<SAnimVarListeners>        m_listeners;
-            Memory::CUniquePointer<SAnimationManagerSignals> m_events;
+            // scratch of updateActive(), kept so a frame doesn't allocate. One entry per bezier variable
+            struct SUpdateBatch {
+                std::vector<SBatchEntry>                          vars;
+                std::vector<float>                                speed;
+                std::vector<uint32_t>                             curve;
+                std::vector<float>                                progress;
+                std::vector<float>                                value;
+
+                std::vector<Memory::CSharedPointer<CBezierCurve>> curves;
+                std::vector<SBatchEntry>                          springs;
+            } m_updateBatch;
+
+            // the variable of an entry, if it's still where the batch found it, and wasn't restarted since
+            CBaseAnimatedVariable* batchEntryVar(const SBatchEntry& entry) const;
+
+            friend class CBaseAnimatedVariable;
         };
     }
 }
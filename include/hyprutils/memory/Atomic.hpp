@@ -3,6 +3,8 @@
 #include "./ImplBase.hpp"
 #include "./SharedPtr.hpp"
 #include "./WeakPtr.hpp"
+#include "./Epoch.hpp"
+#include <atomic>
 #include <mutex>
 
 /*
@@ -19,25 +21,113 @@
       However, if we create a copy of this CAtomicWeakPointer member for each thread that accesses it,
       then the references to the object will be counted in a thread-safe manner and it will be safe to lock a WP and to access the data in case of an SP.
       In such an example, the inner data would need its own synchronization mechanism if it isn't constant itself.
+
+    The refcounting is lock-free, and uses the same control block as CSharedPointer, only with atomic counts
+    (see Impl_::SAtomicCounts). Locking a weak pointer is a CAS loop on the strong count,
+    which fails once the count has dropped to zero.
+
+    Readers that only want to look at the data for a short while can skip the refcount entirely:
+      CEpochGuard guard;
+      if (auto* cfg = weakConfig.peek(guard))
+          use(cfg->value);
+    See Epoch.hpp.
 */
 
 namespace Hyprutils::Memory {
     namespace Atomic_ {
+        /* one of a fixed set of mutexes, picked by address. Backs the deprecated impl::lockGuard() */
+        std::recursive_mutex& legacyMutex(const void* block) noexcept;
+
+        /*
+            Control block of the atomic pointers, the same impl_base as everywhere else, counted
+            with Impl_::SAtomicCounts instead of plain counts.
+            The weak count holds one extra ref on behalf of all strong refs,
+            whoever drops it to zero frees the block.
+        */
         class impl : public Impl_::impl_base {
-            std::recursive_mutex m_mutex;
-
           public:
-            impl(void* data, DeleteFn deleter) noexcept : Impl_::impl_base(data, deleter) {
-                ;
+            using Counts = Impl_::SAtomicCounts;
+
+            /* starts out with one strong ref */
+            impl(void* data, uint32_t deleter) noexcept : Impl_::impl_base(data, deleter) {
+                _ref  = REF_LOCKABLE | REF_ATOMIC | 1;
+                _weak = 1;
+            }
+
+            void incStrong() noexcept {
+                inc<Counts>();
+            }
+
+            /* weak -> strong upgrade. Fails once the strong count hit zero */
+            bool tryIncStrong() noexcept {
+                return tryInc<Counts>();
+            }
+
+            /* may destroy the data, and the block */
+            void decStrong() noexcept {
+                if (dec<Counts>() != 0)
+                    return;
+
+                // a reader might still be peeking, it's on them to finish this
+                if (Impl_::epochDefer(this, &impl::reclaim))
+                    return;
+
+                destroyData();
+                decWeak();
+            }
+
+            void incWeak() noexcept {
+                impl_base::incWeak<Counts>();
+            }
+
+            /* may destroy the block */
+            void decWeak() noexcept {
+                if (impl_base::decWeak<Counts>() == 0)
+                    Impl_::freeImpl(this);
+            }
+
+            unsigned int strongCount() noexcept {
+                return ref<Counts>();
+            }
+
+            /* the weak refs of weak pointers, without the one held on behalf of the strong refs */
+            unsigned int wref() noexcept {
+                const auto WEAK = impl_base::wref<Counts>();
+                return WEAK > 0 && dataAlive() ? WEAK - 1 : WEAK;
+            }
+
+            /* the refcounting doesn't lock anymore, and blocks have no mutex of their own.
+               This locks one shared with other blocks, which still serializes everyone locking this one */
+            [[deprecated("The atomic pointers are lock-free, synchronize the data yourself.")]] std::lock_guard<std::recursive_mutex> lockGuard() {
+                return std::lock_guard<std::recursive_mutex>(legacyMutex(this));
             }
 
-            std::lock_guard<std::recursive_mutex> lockGuard() {
-                return std::lock_guard<std::recursive_mutex>(m_mutex);
+            [[deprecated("The atomic pointers are lock-free, synchronize the data yourself.")]] std::recursive_mutex& getMutex() {
+                return legacyMutex(this);
             }
 
-            // Needed when unlock order or mutex lifetime matters.
-            std::recursive_mutex& getMutex() {
-                return m_mutex;
+            /* whether peeking at the data is allowed, see CEpochGuard */
+            bool peekable() noexcept {
+                return ref<Counts>() != 0;
+            }
+
+            bool dataAlive() noexcept {
+                return std::atomic_ref(_data).load(std::memory_order_acquire) != nullptr;
+            }
+
+          private:
+            static void reclaim(void* self) {
+                auto* impl = sc<Atomic_::impl*>(self);
+                impl->destroyData();
+                impl->decWeak();
+            }
+
+            /* same as impl_base::destroy, weak pointers can deref until the deleter returns */
+            void destroyData() noexcept {
+                Counts::setFlags(_ref, REF_DESTROYING);
+                Impl_::deleterFor(_deleter)(std::atomic_ref(_data).load(std::memory_order_relaxed));
+                std::atomic_ref(_data).store(nullptr, std::memory_order_release);
+                Counts::clearFlags(_ref, REF_DESTROYING);
             }
         };
     }
@@ -54,38 +144,40 @@ namespace Hyprutils::Memory {
         using validHierarchy = std::enable_if_t<std::is_assignable_v<CAtomicSharedPointer<T>&, X>, CAtomicSharedPointer&>;
 
       public:
-        explicit CAtomicSharedPointer(T* object) noexcept : m_ptr(new Atomic_::impl(Impl_::dataPointer(object), _delete), Impl_::dataPointer(object)) {
-            ;
-        }
+        /* how the refs are counted, see CSharedPointerFor */
+        using Counts = Atomic_::impl::Counts;
 
-        CAtomicSharedPointer(Impl_::impl_base* impl, void* data) noexcept : m_ptr(impl, data) {
-            ;
+        explicit CAtomicSharedPointer(T* object) noexcept : m_impl(Impl_::allocImpl<Atomic_::impl>(Impl_::dataPointer(object), Impl_::deleterIndex<&Impl_::deleteData<T>>())), m_data(Impl_::dataPointer(object)) {
+            Impl_::trackBlock<T>(m_impl);
         }
 
-        CAtomicSharedPointer(const CAtomicSharedPointer<T>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
+        /* impl must be the block of another atomic pointer, e.g. for the pointer casts */
+        CAtomicSharedPointer(Impl_::impl_base* impl, void* data) noexcept : m_impl(sc<Atomic_::impl*>(impl)), m_data(data) {
+#ifdef HYPRLAND_DEBUG
+            HYPRUTILS_ASSERT_MSG(!impl || impl->atomicCounts<Counts>(), "CAtomicSharedPointer made from the block of a CSharedPointer");
+#endif
+            if (m_impl)
+                m_impl->incStrong();
+        }
 
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicSharedPointer(const CAtomicSharedPointer<T>& ref) noexcept : CAtomicSharedPointer(ref.m_impl, ref.m_data) {
+            ;
         }
 
         template <typename U, typename = isConstructible<U>>
-        CAtomicSharedPointer(const CAtomicSharedPointer<U>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicSharedPointer(const CAtomicSharedPointer<U>& ref) noexcept : CAtomicSharedPointer(ref.m_impl, Impl_::dataPointer(sc<T*>(ref.get()))) {
+            ;
         }
 
         template <typename U, typename = isConstructible<U>>
-        CAtomicSharedPointer(CAtomicSharedPointer<U>&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+        CAtomicSharedPointer(CAtomicSharedPointer<U>&& ref) noexcept : m_impl(ref.m_impl), m_data(Impl_::dataPointer(sc<T*>(ref.get()))) {
+            ref.m_impl = nullptr;
+            ref.m_data = nullptr;
         }
 
         CAtomicSharedPointer(CAtomicSharedPointer&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+            std::swap(m_impl, ref.m_impl);
+            std::swap(m_data, ref.m_data);
         }
 
         CAtomicSharedPointer() noexcept = default;
@@ -100,139 +192,84 @@ namespace Hyprutils::Memory {
 
         template <typename U>
         validHierarchy<const CAtomicSharedPointer<U>&> operator=(const CAtomicSharedPointer<U>& rhs) {
-            reset();
-
-            if (!rhs.m_ptr.impl_)
-                return *this;
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
-            return *this;
+            return *this = CAtomicSharedPointer(rhs);
         }
 
         CAtomicSharedPointer& operator=(const CAtomicSharedPointer& rhs) {
             if (this == &rhs)
                 return *this;
 
-            reset();
-
-            if (!rhs.m_ptr.impl_)
-                return *this;
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
-            return *this;
+            return *this = CAtomicSharedPointer(rhs);
         }
 
         template <typename U>
         validHierarchy<const CAtomicSharedPointer<U>&> operator=(CAtomicSharedPointer<U>&& rhs) noexcept {
-            std::swap(m_ptr, rhs.m_ptr);
-            return *this;
+            return *this = CAtomicSharedPointer(std::move(rhs));
         }
 
         CAtomicSharedPointer& operator=(CAtomicSharedPointer&& rhs) noexcept {
             if (this == &rhs)
                 return *this;
 
-            std::swap(m_ptr, rhs.m_ptr);
+            std::swap(m_impl, rhs.m_impl);
+            std::swap(m_data, rhs.m_data);
             return *this;
         }
 
         void reset() {
-            if (!m_ptr.impl_)
-                return;
-
-            // last ref and last wref?
-            // -> must unlock BEFORE reset
-            // not last ref?
-            // -> must unlock AFTER reset
-            auto& mutex = sc<Atomic_::impl*>(m_ptr.impl_)->getMutex();
-            mutex.lock();
-
-            if (m_ptr.impl_->ref() > 1) {
-                m_ptr.reset();
-                mutex.unlock();
+            if (!m_impl)
                 return;
-            }
-
-            if (m_ptr.impl_->wref() == 0) {
-                mutex.unlock(); // Don't hold the mutex when destroying it
-
-                m_ptr.impl_->destroy();
-                delete sc<Atomic_::impl*>(m_ptr.impl_);
-                m_ptr.impl_ = nullptr;
-
-                // mutex invalid
-                return;
-            } else {
-                // When the control block gets destroyed, the mutex is destroyed with it.
-                // Thus we must avoid attempting an unlock after impl_ has been destroyed.
-                // Without the workaround is no safe way of checking whether it has been destroyed or not.
-                //
-                // To avoid this altogether, keep a weak pointer here.
-                // This guarantees that impl_ is still valid after the reset.
-                CWeakPointer<T> guard = m_ptr;
-                m_ptr.reset(); // destroys the data
-
-                // Now we can safely check if guard is the last wref.
-                if (guard.impl_->wref() == 1) {
-                    mutex.unlock();
-
-                    // destroy impl_ (includes the mutex)
-                    delete sc<Atomic_::impl*>(guard.impl_);
-                    guard.impl_ = nullptr;
-
-                    // mutex invalid
-                    return;
-                }
 
-                guard.reset();
-                mutex.unlock();
-            }
+            // can destroy thisptr, so clear our state first
+            auto* impl = m_impl;
+            m_impl     = nullptr;
+            m_data     = nullptr;
+            impl->decStrong();
         }
 
         T& operator*() const {
-            return *m_ptr;
+            return *get();
         }
 
         T* operator->() const {
-            return m_ptr.get();
+            return get();
         }
 
         T* get() const {
-            return m_ptr.get();
+            return m_impl && m_impl->dataAlive() ? sc<T*>(m_data) : nullptr;
         }
 
         explicit operator bool() const {
-            return static_cast<bool>(m_ptr);
+            return m_impl && m_impl->dataAlive();
         }
 
         bool operator==(const CAtomicSharedPointer& rhs) const {
-            return m_ptr == rhs.m_ptr;
+            return m_impl == rhs.m_impl;
         }
 
         bool operator()(const CAtomicSharedPointer& lhs, const CAtomicSharedPointer& rhs) const {
-            return lhs.m_ptr == rhs.m_ptr;
+            return lhs.m_impl == rhs.m_impl;
         }
 
         unsigned int strongRef() const {
-            return m_ptr.impl_ ? m_ptr.impl_->ref() : 0;
+            return m_impl ? m_impl->strongCount() : 0;
         }
 
         Atomic_::impl* impl() const {
-            return sc<Atomic_::impl*>(m_ptr.impl_);
+            return m_impl;
         }
 
       private:
-        static void _delete(void* p) {
-            std::default_delete<T>{}(sc<T*>(p));
+        /* takes over a strong ref that was already counted, see CAtomicWeakPointer::lock */
+        struct SAdopt {};
+        CAtomicSharedPointer(SAdopt, Atomic_::impl* impl, void* data) noexcept : m_impl(impl), m_data(data) {
+            ;
         }
 
-        std::lock_guard<std::recursive_mutex> implLockGuard() const {
-            return impl()->lockGuard();
-        }
+        Atomic_::impl* m_impl = nullptr;
 
-        CSharedPointer<T> m_ptr;
+        // Never use directly: raw data ptr, could be UAF
+        void* m_data = nullptr;
 
         template <typename U>
         friend class CAtomicWeakPointer;
@@ -249,44 +286,42 @@ namespace Hyprutils::Memory {
         using validHierarchy = std::enable_if_t<std::is_assignable_v<CAtomicWeakPointer<T>&, X>, CAtomicWeakPointer&>;
 
       public:
-        CAtomicWeakPointer(const CAtomicWeakPointer<T>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
+        /* how the refs are counted, see CSharedPointerFor */
+        using Counts = Atomic_::impl::Counts;
 
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicWeakPointer(const CAtomicWeakPointer<T>& ref) noexcept : CAtomicWeakPointer(ref.m_impl, ref.m_data) {
+            ;
         }
 
         template <typename U, typename = isConstructible<U>>
-        CAtomicWeakPointer(const CAtomicWeakPointer<U>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicWeakPointer(const CAtomicWeakPointer<U>& ref) noexcept : CAtomicWeakPointer(ref.m_impl, Impl_::dataPointer(sc<T*>(ref.get()))) {
+            ;
         }
 
         template <typename U, typename = isConstructible<U>>
-        CAtomicWeakPointer(CAtomicWeakPointer<U>&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+        CAtomicWeakPointer(CAtomicWeakPointer<U>&& ref) noexcept : m_impl(ref.m_impl), m_data(Impl_::dataPointer(sc<T*>(ref.get()))) {
+            ref.m_impl = nullptr;
+            ref.m_data = nullptr;
         }
 
         CAtomicWeakPointer(CAtomicWeakPointer&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+            std::swap(m_impl, ref.m_impl);
+            std::swap(m_data, ref.m_data);
         }
 
-        CAtomicWeakPointer(const CAtomicSharedPointer<T>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicWeakPointer(const CAtomicSharedPointer<T>& ref) noexcept : CAtomicWeakPointer(ref.m_impl, ref.m_data) {
+            ;
         }
 
         CAtomicWeakPointer() noexcept = default;
 
-        CAtomicWeakPointer(Impl_::impl_base* implementation, void* data) noexcept : m_ptr(implementation, data) {
-            ;
+        /* same as CAtomicSharedPointer's, implementation must be the block of another atomic pointer */
+        CAtomicWeakPointer(Impl_::impl_base* implementation, void* data) noexcept : m_impl(sc<Atomic_::impl*>(implementation)), m_data(data) {
+#ifdef HYPRLAND_DEBUG
+            HYPRUTILS_ASSERT_MSG(!implementation || implementation->atomicCounts<Counts>(), "CAtomicWeakPointer made from the block of a CSharedPointer");
+#endif
+            if (m_impl)
+                m_impl->incWeak();
         }
 
         CAtomicWeakPointer(std::nullptr_t) noexcept {
@@ -299,125 +334,99 @@ namespace Hyprutils::Memory {
 
         template <typename U>
         validHierarchy<const CAtomicWeakPointer<U>&> operator=(const CAtomicWeakPointer<U>& rhs) {
-            reset();
-
-            if (!rhs.m_ptr.impl_)
-                return *this;
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
-            return *this;
+            return *this = CAtomicWeakPointer(rhs);
         }
 
         CAtomicWeakPointer& operator=(const CAtomicWeakPointer& rhs) {
             if (this == &rhs)
                 return *this;
 
-            reset();
-
-            if (!rhs.m_ptr.impl_)
-                return *this;
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
-            return *this;
+            return *this = CAtomicWeakPointer(rhs);
         }
 
         template <typename U>
         validHierarchy<const CAtomicWeakPointer<U>&> operator=(CAtomicWeakPointer<U>&& rhs) noexcept {
-            std::swap(m_ptr, rhs.m_ptr);
-            return *this;
+            return *this = CAtomicWeakPointer(std::move(rhs));
         }
 
         CAtomicWeakPointer& operator=(CAtomicWeakPointer&& rhs) noexcept {
             if (this == &rhs)
                 return *this;
 
-            std::swap(m_ptr, rhs.m_ptr);
+            std::swap(m_impl, rhs.m_impl);
+            std::swap(m_data, rhs.m_data);
             return *this;
         }
 
         void reset() {
-            if (!m_ptr.impl_)
+            if (!m_impl)
                 return;
 
-            // last ref and last wref?
-            // -> must unlock BEFORE reset
-            // not last ref?
-            // -> must unlock AFTER reset
-            auto& mutex = sc<Atomic_::impl*>(m_ptr.impl_)->getMutex();
-            mutex.lock();
-            if (m_ptr.impl_->ref() == 0 && m_ptr.impl_->wref() == 1) {
-                mutex.unlock();
-
-                delete sc<Atomic_::impl*>(m_ptr.impl_);
-                m_ptr.impl_ = nullptr;
-                // mutex invalid
-                return;
-            }
-
-            m_ptr.reset();
-            mutex.unlock();
+            auto* impl = m_impl;
+            m_impl     = nullptr;
+            m_data     = nullptr;
+            impl->decWeak();
         }
 
         T& operator*() const {
-            return *m_ptr;
+            return *get();
         }
 
         T* operator->() const {
-            return m_ptr.get();
+            return get();
         }
 
+        /* see CWeakPointer::valid, this still returns the data while it's being destroyed */
         T* get() const {
-            return m_ptr.get();
+            return m_impl && m_impl->dataAlive() ? sc<T*>(m_data) : nullptr;
         }
 
         explicit operator bool() const {
-            return static_cast<bool>(m_ptr);
+            return m_impl && m_impl->dataAlive();
         }
 
         bool operator==(const CAtomicWeakPointer& rhs) const {
-            return m_ptr == rhs.m_ptr;
+            return m_impl == rhs.m_impl;
         }
 
         bool operator==(const CAtomicSharedPointer<T>& rhs) const {
-            return m_ptr == rhs.m_ptr;
+            return m_impl == rhs.m_impl;
         }
 
         bool operator()(const CAtomicWeakPointer& lhs, const CAtomicWeakPointer& rhs) const {
-            return lhs.m_ptr == rhs.m_ptr;
+            return lhs.m_impl == rhs.m_impl;
         }
 
         bool expired() {
-            return m_ptr.expired();
+            return !m_impl || m_impl->strongCount() == 0;
         }
 
         bool valid() {
-            return m_ptr.valid();
+            return m_impl && m_impl->dataAlive();
         }
 
-        CAtomicSharedPointer<T> lock() const {
-            if (!m_ptr.impl_)
-                return {};
-
-            auto lg = implLockGuard();
+        /* returns the data without taking a ref, or nullptr if the last strong ref is gone.
+           The pointer stays valid for as long as the guard is alive. */
+        T* peek(const CEpochGuard&) const {
+            return m_impl && m_impl->peekable() ? sc<T*>(m_data) : nullptr;
+        }
 
-            if (!m_ptr.impl_->dataNonNull() || m_ptr.impl_->destroying() || !m_ptr.impl_->lockable())
+        CAtomicSharedPointer<T> lock() const {
+            if (!m_impl || !m_impl->tryIncStrong())
                 return {};
 
-            return CAtomicSharedPointer<T>(m_ptr.impl_, m_ptr.m_data);
+            return CAtomicSharedPointer<T>(typename CAtomicSharedPointer<T>::SAdopt{}, m_impl, m_data);
         }
 
         Atomic_::impl* impl() const {
-            return sc<Atomic_::impl*>(m_ptr.impl_);
+            return m_impl;
         }
 
       private:
-        std::lock_guard<std::recursive_mutex> implLockGuard() const {
-            return impl()->lockGuard();
-        }
+        Atomic_::impl* m_impl = nullptr;
 
-        CWeakPointer<T> m_ptr;
+        // Never use directly: raw data ptr, could be UAF
+        void* m_data = nullptr;
 
         template <typename U>
         friend class CAtomicWeakPointer;
@@ -430,6 +439,25 @@ namespace Hyprutils::Memory {
         return CAtomicSharedPointer<U>(new U(std::forward<Args>(args)...));
     }
 
+    /*
+        The pointers counting their refs with the policy C, for code that is generic over thread-safety:
+        Impl_::SPlainCounts gives CSharedPointer and CWeakPointer, Impl_::SAtomicCounts the atomic ones.
+        Both sit on the same impl_base, only the counting differs.
+    */
+    template <typename T, typename C = Impl_::SPlainCounts>
+    using CSharedPointerFor = std::conditional_t<C::THREADSAFE, CAtomicSharedPointer<T>, CSharedPointer<T>>;
+
+    template <typename T, typename C = Impl_::SPlainCounts>
+    using CWeakPointerFor = std::conditional_t<C::THREADSAFE, CAtomicWeakPointer<T>, CWeakPointer<T>>;
+
+    template <typename C, typename U, typename... Args>
+    [[nodiscard]] inline CSharedPointerFor<U, C> makeSharedFor(Args&&... args) {
+        if constexpr (C::THREADSAFE)
+            return makeAtomicShared<U>(std::forward<Args>(args)...);
+        else
+            return makeShared<U>(std::forward<Args>(args)...);
+    }
+
     template <typename T, typename U>
     CAtomicSharedPointer<T> reinterpretPointerCast(const CAtomicSharedPointer<U>& ref) {
         return CAtomicSharedPointer<T>(ref.impl(), Impl_::dataPointer(ref.get()));
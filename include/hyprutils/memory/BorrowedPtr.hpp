@@ -0,0 +1,147 @@
+#pragma once
+
+#include "./SharedPtr.hpp"
+#include "./UniquePtr.hpp"
+#include "./WeakPtr.hpp"
+#include "./Casts.hpp"
+#include "../misc/HyprAssert.hpp"
+
+/*
+    A non-owning pointer to an object owned by a CSharedPointer, CWeakPointer or CUniquePointer.
+
+    Creating, copying and destroying one never touches the refcounts, which makes it
+    the thing to pass into calls that only use the object for their duration.
+    It is the caller's job to keep the owner alive for that long.
+    With HYPRLAND_DEBUG, dereferencing one whose object is already gone asserts, see Impl_::dataAlive.
+
+    It can still be turned back into a CWeakPointer, or locked into a CSharedPointer,
+    should the callee want to keep a ref around.
+*/
+
+namespace Hyprutils {
+    namespace Memory {
+        template <typename T>
+        class CBorrowedPointer {
+          public:
+            template <typename X>
+            using isConstructible = std::enable_if_t<std::is_constructible_v<T&, X&>>;
+
+            template <typename U, typename = isConstructible<U>>
+            CBorrowedPointer(const CSharedPointer<U>& ref) noexcept : impl_(ref.get() ? ref.impl_ : nullptr), m_data(Impl_::dataPointer(sc<T*>(ref.get()))) {
+                ;
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CBorrowedPointer(const CWeakPointer<U>& ref) noexcept : impl_(ref.get() ? ref.impl_ : nullptr), m_data(Impl_::dataPointer(sc<T*>(ref.get()))) {
+                ;
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CBorrowedPointer(const CUniquePointer<U>& ref) noexcept : impl_(ref.get() ? ref.impl_ : nullptr), m_data(Impl_::dataPointer(sc<T*>(ref.get()))) {
+                ;
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CBorrowedPointer(const CBorrowedPointer<U>& ref) noexcept : impl_(ref.impl_), m_data(Impl_::dataPointer(sc<T*>(ref.get()))) {
+                ;
+            }
+
+            CBorrowedPointer(const CBorrowedPointer& ref) noexcept            = default;
+            CBorrowedPointer& operator=(const CBorrowedPointer& ref) noexcept = default;
+
+            /* creates an empty borrowed pointer */
+            CBorrowedPointer() noexcept = default;
+
+            /* creates an empty borrowed pointer */
+            CBorrowedPointer(std::nullptr_t) noexcept {
+                ; // empty
+            }
+
+            /* takes a weak ref, for callees that want to keep it */
+            template <typename U, typename = std::enable_if_t<std::is_constructible_v<U&, T&>>>
+            operator CWeakPointer<U>() const {
+                if (!impl_)
+                    return {};
+
+                return CWeakPointer<U>(impl_, Impl_::dataPointer(sc<U*>(get())));
+            }
+
+            CWeakPointer<T> weak() const {
+                return *this;
+            }
+
+            /* see CWeakPointer::lock */
+            CSharedPointer<T> lock() const {
+                return weak().lock();
+            }
+
+            T* get() const {
+#ifdef HYPRLAND_DEBUG
+                HYPRUTILS_ASSERT_MSG(!impl_ || Impl_::dataAlive(impl_), "CBorrowedPointer outlived the object it points to");
+#endif
+                return sc<T*>(m_data);
+            }
+
+            T* operator->() const {
+                return get();
+            }
+
+            T& operator*() const {
+                return *get();
+            }
+
+            explicit operator bool() const {
+                return m_data;
+            }
+
+            bool operator==(const CBorrowedPointer& rhs) const {
+                return impl_ == rhs.impl_;
+            }
+
+            bool operator==(const CSharedPointer<T>& rhs) const {
+                return impl_ == rhs.impl_;
+            }
+
+            bool operator==(const CWeakPointer<T>& rhs) const {
+                return impl_ == rhs.impl_;
+            }
+
+            bool operator==(const CUniquePointer<T>& rhs) const {
+                return impl_ == rhs.impl_;
+            }
+
+            bool operator==(std::nullptr_t) const {
+                return !m_data;
+            }
+
+            bool operator<(const CBorrowedPointer& rhs) const {
+                return rc<uintptr_t>(impl_) < rc<uintptr_t>(rhs.impl_);
+            }
+
+            Impl_::impl_base* impl_ = nullptr;
+
+            // Never use directly: raw data ptr, could be UAF
+            void* m_data = nullptr;
+        };
+
+        template <typename T, typename U>
+        CBorrowedPointer<T> dynamicPointerCast(const CBorrowedPointer<U>& ref) {
+            if (!ref)
+                return nullptr;
+            T* newPtr = dynamic_cast<T*>(ref.get());
+            if (!newPtr)
+                return nullptr;
+            CBorrowedPointer<T> borrowed;
+            borrowed.impl_  = ref.impl_;
+            borrowed.m_data = Impl_::dataPointer(newPtr);
+            return borrowed;
+        }
+    }
+}
+
+template <typename T>
+struct std::hash<Hyprutils::Memory::CBorrowedPointer<T>> {
+    std::size_t operator()(const Hyprutils::Memory::CBorrowedPointer<T>& p) const noexcept {
+        return std::hash<void*>{}(p.impl_);
+    }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    An optional size-class free-list pool for the control blocks (impl_base and friends)
+    of the Hyprutils smart pointers.
+
+    Freed blocks are kept in thread-local free lists and handed out again on the next allocation
+    of the same size class, instead of going through malloc/free every time.
+    The pool is off by default. It can be enabled globally, and overridden per thread.
+
+    Blocks are only ever cached by the thread that frees them, so a block allocated on one thread
+    and released on another simply migrates. Cached blocks of a thread are released when it exits.
+*/
+
+namespace Hyprutils::Memory {
+    enum ePoolMode : uint8_t {
+        POOL_MODE_INHERIT = 0, /* follow the global setting */
+        POOL_MODE_ENABLED,
+        POOL_MODE_DISABLED,
+    };
+
+    struct SControlBlockPoolStats {
+        /* blocks allocated through the pool that have not been freed yet */
+        size_t liveBlocks = 0;
+        /* allocations served from a free list */
+        size_t hits = 0;
+        /* allocations that had to go to the system allocator */
+        size_t misses = 0;
+    };
+
+    namespace ControlBlockPool {
+        /* enables or disables the pool for every thread in POOL_MODE_INHERIT */
+        void setEnabled(bool enabled);
+
+        /* overrides the global setting for the calling thread */
+        void setThreadMode(ePoolMode mode);
+
+        /* whether allocations on the calling thread go through the pool */
+        bool enabled();
+
+        /* stats are global and only track blocks allocated while the pool was enabled */
+        SControlBlockPoolStats stats();
+        void                   resetStats();
+
+        /* releases all blocks cached by the calling thread */
+        void trim();
+    }
+
+    namespace Impl_ {
+        /* size class of blocks living in a CObjectPool slab, see ObjectPool.hpp */
+        constexpr uint8_t SIZECLASS_SLAB = 0xFF;
+
+        /* returns storage for a control block of at least size bytes, sizeClass is 0 if not pooled */
+        void* allocBlock(std::size_t size, uint8_t& sizeClass);
+        void  freeBlock(void* block, uint8_t sizeClass) noexcept;
+
+        /* gives a block back to the slab it came from, see ObjectPool.hpp */
+        void freeSlabBlock(void* block) noexcept;
+
+        /* with HYPRLAND_DEBUG, the library keeps a set of the live blocks, see dataAlive. A no-op otherwise */
+        void markBlock(void* block, bool live) noexcept;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Opt-in deferred destruction for CSharedPointer.
+
+    With it enabled on a thread, an object whose last CSharedPointer is dropped on that thread
+    is not destroyed right away, but put on a per-thread retire list. The app then destroys
+    those at a safe point by calling drain(), e.g. after CAnimationManager::tickDone(),
+    instead of having a whole object graph torn down in the middle of a frame.
+
+    A retired object behaves like one being destroyed: weak pointers to it are expired()
+    and can no longer be locked, but stay valid() until it is drained.
+    Objects retired while draining (cascades) end up on the same list.
+
+    Whatever is left on the list is destroyed when the thread exits.
+*/
+
+namespace Hyprutils::Memory {
+    namespace DeferredDestruction {
+        /* enables or disables deferred destruction on the calling thread.
+           Disabling it does not drain already retired objects. */
+        void setEnabled(bool enabled);
+        bool enabled();
+
+        /* amount of objects retired on the calling thread waiting to be destroyed */
+        size_t pending();
+
+        /* destroys up to max retired objects of the calling thread, including the ones retired
+           by their destructors. Returns the amount destroyed. */
+        size_t drain(size_t max = SIZE_MAX);
+    }
+
+    namespace Impl_ {
+        class impl_base;
+
+        /* whether the calling thread defers. Inline, so dropping a last ref only leaves the header when it does */
+        inline thread_local bool t_deferring = false;
+
+        /* queues impl for destruction, the calling thread must defer */
+        void retire(impl_base* impl);
+    }
+}
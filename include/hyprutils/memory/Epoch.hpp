@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+    Epoch-based reclamation for the atomic pointers.
+
+    A CEpochGuard pins the calling thread. While it is alive, data obtained through
+    CAtomicWeakPointer::peek() stays valid, even if the last strong ref is dropped by another thread.
+    Pinning only writes to a cache line owned by the pinning thread, so any amount of readers
+    can peek at the same object without contending on its refcount.
+
+    The price is paid by whoever drops the last strong ref: it checks whether any reader is pinned,
+    and if so, the object's destruction is put off until those readers are gone. If no reader is pinned,
+    the object is destroyed right away, like it always was.
+*/
+
+namespace Hyprutils::Memory {
+    class CEpochGuard {
+      public:
+        /* guards can be nested, only the outermost one pins */
+        CEpochGuard();
+        ~CEpochGuard();
+
+        CEpochGuard(const CEpochGuard&)            = delete;
+        CEpochGuard(CEpochGuard&&)                 = delete;
+        CEpochGuard& operator=(const CEpochGuard&) = delete;
+        CEpochGuard& operator=(CEpochGuard&&)      = delete;
+    };
+
+    namespace Epoch {
+        /* destroys whatever is not visible to a pinned reader anymore. Returns how many were destroyed.
+           Done automatically when a guard goes away, you only need this to reclaim eagerly. */
+        size_t collect();
+
+        /* amount of objects waiting for readers to leave */
+        size_t pending();
+    }
+
+    namespace Impl_ {
+        using ReclaimFn = void (*)(void*);
+
+        /* to be called after the strong count of obj dropped to zero.
+           If a reader might still be looking at it, queues fn(obj) for later and returns true. */
+        bool epochDefer(void* obj, ReclaimFn fn);
+    }
+}
@@ -1,7 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <new>
+
+#include "ControlBlockPool.hpp"
+#include "Tracker.hpp"
+#include "../misc/HyprAssert.hpp"
 
 namespace Hyprutils {
     namespace Memory {
@@ -11,48 +19,195 @@ namespace Hyprutils {
                 return const_cast<void*>(static_cast<const void*>(ptr));
             }
 
+            using DeleteFn = void (*)(void*);
+
+            /*
+                Deleters are stored as an index into a global table instead of a function pointer,
+                which keeps impl_base small. Index 0 means no deleter.
+            */
+            uint32_t registerDeleter(DeleteFn fn);
+            DeleteFn deleterFor(uint32_t index) noexcept;
+
+            template <DeleteFn FN>
+            uint32_t deleterIndex() {
+                static const uint32_t INDEX = registerDeleter(FN);
+                return INDEX;
+            }
+
+            /* deletes a T made with new, or a T[] made with new[] */
+            template <typename T>
+            void deleteData(void* p) {
+                std::default_delete<T>{}(static_cast<std::remove_extent_t<T>*>(p));
+            }
+
+            /* only destroys a T, the storage belongs to someone else (see makeInline) */
+            template <typename T>
+            void destroyData(void* p) {
+                std::destroy_at(static_cast<T*>(p));
+            }
+
+            /*
+                How a control block counts. Both policies work on the same fields, so there is one
+                control block for all pointers: CSharedPointer and friends count plainly,
+                the atomic pointers (see Atomic.hpp) go through std::atomic_ref.
+            */
+            struct SPlainCounts {
+                static constexpr bool THREADSAFE = false;
+
+                static uint32_t       load(uint32_t& count) noexcept {
+                    return count;
+                }
+
+                static void add(uint32_t& count) noexcept {
+                    count++;
+                }
+
+                /* returns what is left */
+                static uint32_t sub(uint32_t& count) noexcept {
+                    return --count;
+                }
+
+                /* adds one, unless the bits in mask are all zero */
+                static bool addUnlessZero(uint32_t& count, uint32_t mask) noexcept {
+                    if ((count & mask) == 0)
+                        return false;
+
+                    count++;
+                    return true;
+                }
+
+                static void setFlags(uint32_t& count, uint32_t flags) noexcept {
+                    count |= flags;
+                }
+
+                static void clearFlags(uint32_t& count, uint32_t flags) noexcept {
+                    count &= ~flags;
+                }
+            };
+
+            struct SAtomicCounts {
+                static constexpr bool THREADSAFE = true;
+
+                static uint32_t       load(uint32_t& count) noexcept {
+                    return std::atomic_ref(count).load(std::memory_order_acquire);
+                }
+
+                static void add(uint32_t& count) noexcept {
+                    std::atomic_ref(count).fetch_add(1, std::memory_order_relaxed);
+                }
+
+                static uint32_t sub(uint32_t& count) noexcept {
+                    return std::atomic_ref(count).fetch_sub(1, std::memory_order_acq_rel) - 1;
+                }
+
+                static bool addUnlessZero(uint32_t& count, uint32_t mask) noexcept {
+                    std::atomic_ref ref(count);
+                    uint32_t        current = ref.load(std::memory_order_relaxed);
+
+                    while ((current & mask) != 0) {
+                        if (ref.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                            return true;
+                    }
+
+                    return false;
+                }
+
+                static void setFlags(uint32_t& count, uint32_t flags) noexcept {
+                    std::atomic_ref(count).fetch_or(flags, std::memory_order_relaxed);
+                }
+
+                static void clearFlags(uint32_t& count, uint32_t flags) noexcept {
+                    std::atomic_ref(count).fetch_and(~flags, std::memory_order_relaxed);
+                }
+            };
+
+            /* a small id of the calling thread, never 0. Used by the debug thread checks of impl_base */
+            uint16_t threadToken() noexcept;
+
             class impl_base {
               public:
-                using DeleteFn = void (*)(void*);
+                using DeleteFn = Impl_::DeleteFn;
 
-                impl_base(void* data, DeleteFn deleter, bool lock = true) noexcept : _lockable(lock), _data(data), _deleter(deleter) {
+                /* the top bits of _ref are flags */
+                static constexpr uint32_t REF_LOCKABLE   = 1U << 31;
+                static constexpr uint32_t REF_DESTROYING = 1U << 30;
+                /* queued for deferred destruction, see DeferredDestruction.hpp */
+                static constexpr uint32_t REF_RETIRED    = 1U << 29;
+                /* counted with SAtomicCounts, set for good by Atomic_::impl */
+                static constexpr uint32_t REF_ATOMIC     = 1U << 28;
+                static constexpr uint32_t REF_COUNT_MASK = REF_ATOMIC - 1;
+
+                impl_base(void* data, uint32_t deleter, bool lock = true) noexcept : _ref(lock ? REF_LOCKABLE : 0), _data(data), _deleter(deleter) {
                     ;
                 }
 
+                template <typename C = SPlainCounts>
                 void inc() noexcept {
-                    _ref++;
+                    checkThread<C>();
+                    C::add(_ref);
+                }
+
+                /* returns the strong count left */
+                template <typename C = SPlainCounts>
+                unsigned int dec() noexcept {
+                    checkThread<C>();
+                    return C::sub(_ref) & REF_COUNT_MASK;
                 }
 
-                void dec() noexcept {
-                    _ref--;
+                /* weak -> strong upgrade, fails once the strong count hit zero */
+                template <typename C = SPlainCounts>
+                bool tryInc() noexcept {
+                    checkThread<C>();
+                    return C::addUnlessZero(_ref, REF_COUNT_MASK);
                 }
 
+                template <typename C = SPlainCounts>
                 void incWeak() noexcept {
-                    _weak++;
+                    checkThread<C>();
+                    C::add(_weak);
                 }
 
-                void decWeak() noexcept {
-                    _weak--;
+                /* returns the weak count left */
+                template <typename C = SPlainCounts>
+                unsigned int decWeak() noexcept {
+                    checkThread<C>();
+                    return C::sub(_weak);
                 }
 
+                template <typename C = SPlainCounts>
                 unsigned int ref() noexcept {
-                    return _ref;
+                    return C::load(_ref) & REF_COUNT_MASK;
                 }
 
+                template <typename C = SPlainCounts>
                 unsigned int wref() noexcept {
-                    return _weak;
+                    return C::load(_weak);
                 }
 
                 void destroy() noexcept {
                     _destroy();
                 }
 
+                /* a retired object is as good as being destroyed, it just has not happened yet */
                 bool destroying() noexcept {
-                    return _destroying;
+                    return _ref & (REF_DESTROYING | REF_RETIRED);
+                }
+
+                bool retired() noexcept {
+                    return _ref & REF_RETIRED;
+                }
+
+                void setRetired() noexcept {
+                    _ref |= REF_RETIRED;
                 }
 
                 bool lockable() noexcept {
-                    return _lockable;
+                    return _ref & REF_LOCKABLE;
+                }
+
+                template <typename C = SPlainCounts>
+                bool atomicCounts() noexcept {
+                    return C::load(_ref) & REF_ATOMIC;
                 }
 
                 bool dataNonNull() noexcept {
@@ -63,40 +218,216 @@ namespace Hyprutils {
                     return _data;
                 }
 
+                /* see ControlBlockPool.hpp, set by allocImpl */
+                uint8_t sizeClass() noexcept {
+                    return _sizeClass;
+                }
+
+                void setSizeClass(uint8_t sizeClass) noexcept {
+                    _sizeClass = sizeClass;
+                }
+
+                /* see Tracker.hpp, set once the block is sampled */
+                bool tracked() noexcept {
+                    return _tracked;
+                }
+
+                void setTracked() noexcept {
+                    _tracked = true;
+                }
+
                 ~impl_base() {
                     destroy();
                 }
 
-              private:
-                /* strong refcount */
-                unsigned int _ref = 0;
+                /* a block may carry the managed object right behind it (see makeInline), or be rounded up
+                   to a pool size class, so it must never be released through a sized delete of sizeof(impl_base).
+                   Prefer allocImpl / freeImpl, which also keep the pool stats right. */
+                static void* operator new(std::size_t size) {
+                    return ::operator new(size);
+                }
+
+                static void operator delete(void* p) noexcept {
+                    ::operator delete(p);
+                }
+
+              protected:
+                // Atomic_::impl works on these through std::atomic_ref
+
+                /* strong refcount, and the REF_ flags */
+                uint32_t _ref = REF_LOCKABLE;
                 /* weak refcount */
-                unsigned int _weak = 0;
-                /* if this is lockable (shared) */
-                bool  _lockable = true;
+                uint32_t _weak = 0;
 
-                void* _data = nullptr;
+                void*    _data = nullptr;
 
-                /* if the destructor was called,
-                   creating shared_ptrs is no longer valid */
-                bool _destroying = false;
+                /* index of the deleter, see deleterFor */
+                uint32_t _deleter = 0;
+                /* pool size class of the block, 0 if not pooled */
+                uint8_t _sizeClass = 0;
+                /* with HYPRUTILS_TRACK_POINTERS, whether the tracker sampled the block. Lives in padding as well */
+                bool _tracked = false;
+                /* with HYPRLAND_DEBUG, the thread counting on this block. Lives in padding, so the layout doesn't depend on it */
+                uint16_t _thread = 0;
 
-                void _destroy() {
-                    if (!_data || _destroying)
+                /*
+                    Plain counts are not thread-safe, so with HYPRLAND_DEBUG, a block counted from two threads traps.
+                    The last ref may move to another thread though, there's nobody left to race with.
+                */
+                template <typename C>
+                void checkThread() noexcept {
+#ifdef HYPRLAND_DEBUG
+                    if constexpr (!C::THREADSAFE) {
+                        const auto TOKEN = threadToken();
+                        if (_thread == TOKEN)
+                            return;
+
+                        HYPRUTILS_ASSERT_MSG(_thread == 0 || (_ref & REF_COUNT_MASK) + _weak <= 1,
+                                             "a CSharedPointer / CWeakPointer was shared across threads, use CAtomicSharedPointer");
+                        _thread = TOKEN;
+                    }
+#endif
+                }
+
+                void    _destroy() {
+                    if (!_data || (_ref & REF_DESTROYING))
                         return;
 
                     // first, we destroy the data, but keep the pointer.
                     // this way, weak pointers will still be able to
                     // reference and use, but no longer create shared ones.
-                    _destroying = true;
-                    _deleter(_data);
+                    _ref |= REF_DESTROYING;
+                    deleterFor(_deleter)(_data);
                     // now, we can reset the data and call it a day.
-                    _data       = nullptr;
-                    _destroying = false;
+                    _data = nullptr;
+                    _ref &= ~(REF_DESTROYING | REF_RETIRED);
                 }
-
-                DeleteFn _deleter = nullptr;
             };
+
+            /*
+                lets Tracker.hpp find strong refs held by other objects. slot is the impl_ member of a CSharedPointer,
+                which only registers while it points into a sampled block, and must untrack before impl_ changes.
+            */
+            inline void trackInstance(impl_base* const* slot) {
+#ifdef HYPRUTILS_TRACK_POINTERS
+                if (*slot && (*slot)->tracked())
+                    registerInstance(slot);
+#endif
+            }
+
+            inline void untrackInstance(impl_base* const* slot) noexcept {
+#ifdef HYPRUTILS_TRACK_POINTERS
+                if (*slot && (*slot)->tracked())
+                    unregisterInstance(slot);
+#endif
+            }
+
+            /*
+                whether the object of impl is alive. With HYPRLAND_DEBUG, a block that was already freed
+                reads as dead instead of being read, which is what lets CBorrowedPointer check it without a ref.
+                Only as good as impl_base::dataNonNull if the library was built without it.
+            */
+            bool dataAlive(impl_base* impl) noexcept;
+
+            // 64-bit: two counts, the data pointer, and the deleter index + size class + tracked + thread
+            static_assert(sizeof(void*) != 8 || sizeof(impl_base) == 24, "impl_base layout grew");
+
+            /* allocates a control block of type B, through the pool if enabled */
+            template <typename B = impl_base, typename... Args>
+            B* allocImpl(Args&&... args) {
+                uint8_t sizeClass = 0;
+                void*   block     = allocBlock(sizeof(B), sizeClass);
+                auto*   impl      = ::new (block) B(std::forward<Args>(args)...);
+                impl->setSizeClass(sizeClass);
+                return impl;
+            }
+
+            /* destroys and frees a control block made by allocImpl or makeInline */
+            template <typename B>
+            void freeImpl(B* impl) noexcept {
+                const auto SIZECLASS = impl->sizeClass();
+#ifdef HYPRUTILS_TRACK_POINTERS
+                unregisterBlock(impl);
+#endif
+                impl->~B();
+                freeBlock(impl, SIZECLASS);
+            }
+
+            /* offset of the object storage in a block made by makeInline */
+            template <typename T>
+            constexpr std::size_t inlineDataOffset() noexcept {
+                return (sizeof(impl_base) + alignof(T) - 1) & ~(alignof(T) - 1);
+            }
+
+            /* whether T can live in the same allocation as its control block */
+            template <typename T>
+            constexpr bool canInline() noexcept {
+                return alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+            }
+
+            /*
+                allocates a control block and the object in a single allocation.
+                The deleter only runs the destructor, the storage is released together
+                with the block, which means it stays valid until the last weak ref is gone.
+            */
+            template <typename T, typename... Args>
+            impl_base* makeInline(bool lockable, Args&&... args) {
+                using Stored             = std::remove_cv_t<T>;
+                uint8_t        sizeClass = 0;
+                unsigned char* block     = static_cast<unsigned char*>(allocBlock(inlineDataOffset<T>() + sizeof(T), sizeClass));
+
+                Stored*        data = nullptr;
+                try {
+                    data = ::new (block + inlineDataOffset<T>()) Stored(std::forward<Args>(args)...);
+                } catch (...) {
+                    freeBlock(block, sizeClass);
+                    throw;
+                }
+
+                auto* impl = ::new (block) impl_base(dataPointer(data), deleterIndex<&destroyData<Stored>>(), lockable);
+                impl->setSizeClass(sizeClass);
+                trackBlock<Stored>(impl);
+                return impl;
+            }
+
+            /* offset of the elements in a block made by makeInlineArray. The element count sits right in front of them */
+            template <typename T>
+            constexpr std::size_t inlineArrayOffset() noexcept {
+                constexpr std::size_t ALIGN = std::max(alignof(T), alignof(std::size_t));
+                return (sizeof(impl_base) + sizeof(std::size_t) + ALIGN - 1) & ~(ALIGN - 1);
+            }
+
+            /* destroys the elements of a block made by makeInlineArray */
+            template <typename T>
+            void destroyInlineArray(void* p) {
+                const auto SIZE = *std::launder(reinterpret_cast<std::size_t*>(static_cast<unsigned char*>(p) - sizeof(std::size_t)));
+                std::destroy_n(static_cast<T*>(p), SIZE);
+            }
+
+            /* same as makeInline, for size value-initialized Ts */
+            template <typename T>
+            impl_base* makeInlineArray(std::size_t size) {
+                if (size > (SIZE_MAX - inlineArrayOffset<T>()) / sizeof(T))
+                    throw std::bad_array_new_length();
+
+                uint8_t        sizeClass = 0;
+                unsigned char* block     = static_cast<unsigned char*>(allocBlock(inlineArrayOffset<T>() + (size * sizeof(T)), sizeClass));
+                auto*          elements  = reinterpret_cast<T*>(block + inlineArrayOffset<T>());
+
+                try {
+                    std::uninitialized_value_construct_n(elements, size);
+                } catch (...) {
+                    freeBlock(block, sizeClass);
+                    throw;
+                }
+
+                ::new (block + inlineArrayOffset<T>() - sizeof(std::size_t)) std::size_t(size);
+
+                auto* impl = ::new (block) impl_base(dataPointer(elements), deleterIndex<&destroyInlineArray<T>>(), true);
+                impl->setSizeClass(sizeClass);
+                trackBlock<T[]>(impl);
+                return impl;
+            }
         }
     }
 
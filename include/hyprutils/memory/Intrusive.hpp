@@ -0,0 +1,423 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "Casts.hpp"
+
+/*
+    Intrusive refcounting.
+
+    Types inheriting from CIntrusiveRefCounted carry their own strong refcount,
+    so CIntrusivePointer is a single pointer wide and a deref is a single load,
+    instead of going through the impl_base like CSharedPointer does.
+
+    Weak refs are rarer, so their state lives in a small block that is only
+    allocated when the first CIntrusiveWeakPointer to an object is made.
+    CIntrusiveWeakPointer is a single pointer wide as well.
+
+    Same as with CSharedPointer, weak pointers can still be used to deref the
+    object while it's being destroyed, but can no longer be locked.
+
+    Like CSharedPointer, this is not thread-safe.
+*/
+
+namespace Hyprutils {
+    namespace Memory {
+        class CIntrusiveRefCounted;
+
+        namespace Impl_ {
+            struct SIntrusiveWeakBlock {
+                /* weak refcount, +1 while the object is alive */
+                unsigned int          weak = 1;
+                /* nullptr once the object is fully destroyed */
+                CIntrusiveRefCounted* object = nullptr;
+                /* if the destructor is running,
+                   creating strong refs is no longer valid */
+                bool destroying = false;
+            };
+
+            inline void decWeakBlock(SIntrusiveWeakBlock* block) noexcept {
+                if (--block->weak == 0)
+                    delete block;
+            }
+        }
+
+        class CIntrusiveRefCounted {
+          public:
+            virtual ~CIntrusiveRefCounted() {
+                if (!m_intrusiveWeak)
+                    return;
+
+                // we are the last thing to be destroyed, weak pointers can't deref anymore
+                m_intrusiveWeak->object     = nullptr;
+                m_intrusiveWeak->destroying = false;
+                Impl_::decWeakBlock(m_intrusiveWeak);
+            }
+
+            unsigned int intrusiveRef() const noexcept {
+                return m_intrusiveRef;
+            }
+
+            unsigned int intrusiveWeakRef() const noexcept {
+                return m_intrusiveWeak ? m_intrusiveWeak->weak - 1 : 0;
+            }
+
+          protected:
+            CIntrusiveRefCounted() noexcept = default;
+
+            // refcounts belong to an object, not to its value
+            CIntrusiveRefCounted(const CIntrusiveRefCounted&) noexcept {
+                ;
+            }
+
+            CIntrusiveRefCounted& operator=(const CIntrusiveRefCounted&) noexcept {
+                return *this;
+            }
+
+          private:
+            // refs taken while the destructor runs, e.g. with this, are not counted, or they would delete us again
+            void incIntrusive() noexcept {
+                if (m_intrusiveDestroying)
+                    return;
+
+                m_intrusiveRef++;
+            }
+
+            void decIntrusive() {
+                if (m_intrusiveDestroying || --m_intrusiveRef != 0)
+                    return;
+
+                m_intrusiveDestroying = true;
+                if (m_intrusiveWeak)
+                    m_intrusiveWeak->destroying = true;
+
+                delete this;
+            }
+
+            Impl_::SIntrusiveWeakBlock* weakBlock() {
+                if (!m_intrusiveWeak)
+                    m_intrusiveWeak = new Impl_::SIntrusiveWeakBlock{.object = this, .destroying = m_intrusiveDestroying};
+
+                return m_intrusiveWeak;
+            }
+
+            unsigned int                m_intrusiveRef        = 0;
+            bool                        m_intrusiveDestroying = false;
+            Impl_::SIntrusiveWeakBlock* m_intrusiveWeak       = nullptr;
+
+            template <typename T>
+            friend class CIntrusivePointer;
+            template <typename T>
+            friend class CIntrusiveWeakPointer;
+        };
+
+        template <typename T>
+        concept IntrusiveType = std::is_base_of_v<CIntrusiveRefCounted, std::remove_cv_t<T>>;
+
+        template <typename T>
+        class CIntrusivePointer {
+          public:
+            template <typename X>
+            using isConstructible = std::enable_if_t<std::is_convertible_v<X*, T*>>;
+
+            /* takes a strong ref to an object. As the count is in the object,
+               this is safe to call even if it's already owned, e.g. with this.
+               During the destructor of the object, the ref is not counted and can't keep it alive */
+            explicit CIntrusivePointer(T* object) noexcept : m_data(object) {
+                increment();
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusivePointer(const CIntrusivePointer<U>& ref) noexcept : m_data(ref.m_data) {
+                increment();
+            }
+
+            CIntrusivePointer(const CIntrusivePointer& ref) noexcept : m_data(ref.m_data) {
+                increment();
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusivePointer(CIntrusivePointer<U>&& ref) noexcept : m_data(std::exchange(ref.m_data, nullptr)) {
+                ;
+            }
+
+            CIntrusivePointer(CIntrusivePointer&& ref) noexcept : m_data(std::exchange(ref.m_data, nullptr)) {
+                ;
+            }
+
+            CIntrusivePointer() noexcept = default;
+
+            CIntrusivePointer(std::nullptr_t) noexcept {
+                ; // empty
+            }
+
+            ~CIntrusivePointer() {
+                decrement(m_data);
+            }
+
+            CIntrusivePointer& operator=(const CIntrusivePointer& rhs) {
+                if (m_data == rhs.m_data)
+                    return *this;
+
+                T* old = m_data;
+                m_data = rhs.m_data;
+                increment();
+                decrement(old);
+                return *this;
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusivePointer& operator=(const CIntrusivePointer<U>& rhs) {
+                return *this = CIntrusivePointer(rhs);
+            }
+
+            CIntrusivePointer& operator=(CIntrusivePointer&& rhs) noexcept {
+                std::swap(m_data, rhs.m_data);
+                return *this;
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusivePointer& operator=(CIntrusivePointer<U>&& rhs) {
+                return *this = CIntrusivePointer(std::move(rhs));
+            }
+
+            explicit operator bool() const {
+                return m_data;
+            }
+
+            bool operator==(const CIntrusivePointer& rhs) const {
+                return m_data == rhs.m_data;
+            }
+
+            bool operator==(std::nullptr_t) const {
+                return !m_data;
+            }
+
+            bool operator<(const CIntrusivePointer& rhs) const {
+                return rc<uintptr_t>(m_data) < rc<uintptr_t>(rhs.m_data);
+            }
+
+            T* operator->() const {
+                return m_data;
+            }
+
+            T& operator*() const {
+                return *m_data;
+            }
+
+            T* get() const {
+                return m_data;
+            }
+
+            void reset() {
+                decrement(std::exchange(m_data, nullptr));
+            }
+
+            unsigned int strongRef() const {
+                return m_data ? base(m_data)->intrusiveRef() : 0;
+            }
+
+            T* m_data = nullptr;
+
+          private:
+            static CIntrusiveRefCounted* base(T* data) {
+                // checked here, T may still be incomplete when the pointer type is named
+                static_assert(IntrusiveType<T>, "intrusive pointers require T to inherit from CIntrusiveRefCounted");
+                return cc<CIntrusiveRefCounted*>(sc<const CIntrusiveRefCounted*>(data));
+            }
+
+            void increment() {
+                if (m_data)
+                    base(m_data)->incIntrusive();
+            }
+
+            /* may destroy the object, so this can't touch thisptr after */
+            static void decrement(T* data) {
+                if (data)
+                    base(data)->decIntrusive();
+            }
+        };
+
+        template <typename T>
+        class CIntrusiveWeakPointer {
+          public:
+            template <typename X>
+            using isConstructible = std::enable_if_t<std::is_convertible_v<X*, T*>>;
+
+            /* create a weak ptr from a raw object, e.g. this */
+            explicit CIntrusiveWeakPointer(T* object) noexcept {
+                if (object)
+                    m_block = base(object)->weakBlock();
+
+                incrementWeak();
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusiveWeakPointer(const CIntrusivePointer<U>& ref) noexcept : CIntrusiveWeakPointer(sc<T*>(ref.get())) {
+                ;
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusiveWeakPointer(const CIntrusiveWeakPointer<U>& ref) noexcept : m_block(ref.m_block) {
+                incrementWeak();
+            }
+
+            CIntrusiveWeakPointer(const CIntrusiveWeakPointer& ref) noexcept : m_block(ref.m_block) {
+                incrementWeak();
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusiveWeakPointer(CIntrusiveWeakPointer<U>&& ref) noexcept : m_block(std::exchange(ref.m_block, nullptr)) {
+                ;
+            }
+
+            CIntrusiveWeakPointer(CIntrusiveWeakPointer&& ref) noexcept : m_block(std::exchange(ref.m_block, nullptr)) {
+                ;
+            }
+
+            CIntrusiveWeakPointer() noexcept = default;
+
+            CIntrusiveWeakPointer(std::nullptr_t) noexcept {
+                ; // empty
+            }
+
+            ~CIntrusiveWeakPointer() {
+                decrementWeak();
+            }
+
+            CIntrusiveWeakPointer& operator=(const CIntrusiveWeakPointer& rhs) {
+                if (m_block == rhs.m_block)
+                    return *this;
+
+                decrementWeak();
+                m_block = rhs.m_block;
+                incrementWeak();
+                return *this;
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusiveWeakPointer& operator=(const CIntrusiveWeakPointer<U>& rhs) {
+                return *this = CIntrusiveWeakPointer(rhs);
+            }
+
+            template <typename U, typename = isConstructible<U>>
+            CIntrusiveWeakPointer& operator=(const CIntrusivePointer<U>& rhs) {
+                return *this = CIntrusiveWeakPointer(rhs);
+            }
+
+            CIntrusiveWeakPointer& operator=(CIntrusiveWeakPointer&& rhs) noexcept {
+                std::swap(m_block, rhs.m_block);
+                return *this;
+            }
+
+            /* see CWeakPointer::expired */
+            bool expired() const {
+                return !m_block || !m_block->object || m_block->destroying;
+            }
+
+            /* see CWeakPointer::valid */
+            bool valid() const {
+                return m_block && m_block->object;
+            }
+
+            void reset() {
+                decrementWeak();
+                m_block = nullptr;
+            }
+
+            CIntrusivePointer<T> lock() const {
+                if (expired())
+                    return {};
+
+                return CIntrusivePointer<T>(get());
+            }
+
+            explicit operator bool() const {
+                return valid();
+            }
+
+            bool operator==(const CIntrusiveWeakPointer& rhs) const {
+                return m_block == rhs.m_block;
+            }
+
+            bool operator==(const CIntrusivePointer<T>& rhs) const {
+                return get() == rhs.get();
+            }
+
+            bool operator==(std::nullptr_t) const {
+                return !valid();
+            }
+
+            bool operator<(const CIntrusiveWeakPointer& rhs) const {
+                return rc<uintptr_t>(m_block) < rc<uintptr_t>(rhs.m_block);
+            }
+
+            T* get() const {
+                return valid() ? sc<T*>(m_block->object) : nullptr;
+            }
+
+            T* operator->() const {
+                return get();
+            }
+
+            T& operator*() const {
+                return *get();
+            }
+
+            Impl_::SIntrusiveWeakBlock* m_block = nullptr;
+
+          private:
+            static CIntrusiveRefCounted* base(T* data) {
+                // checked here, T may still be incomplete when the pointer type is named
+                static_assert(IntrusiveType<T>, "intrusive pointers require T to inherit from CIntrusiveRefCounted");
+                return cc<CIntrusiveRefCounted*>(sc<const CIntrusiveRefCounted*>(data));
+            }
+
+            void incrementWeak() {
+                if (m_block)
+                    m_block->weak++;
+            }
+
+            void decrementWeak() {
+                if (m_block)
+                    Impl_::decWeakBlock(m_block);
+            }
+        };
+
+        template <typename U, typename... Args>
+        [[nodiscard]] inline CIntrusivePointer<U> makeIntrusive(Args&&... args) {
+            return CIntrusivePointer<U>(new U(std::forward<Args>(args)...));
+        }
+
+        template <typename T, typename U>
+        CIntrusivePointer<T> dynamicPointerCast(const CIntrusivePointer<U>& ref) {
+            return CIntrusivePointer<T>(dynamic_cast<T*>(ref.get()));
+        }
+
+        template <typename T, typename U>
+        CIntrusiveWeakPointer<T> dynamicPointerCast(const CIntrusiveWeakPointer<U>& ref) {
+            // see dynamicPointerCast for CWeakPointer
+            if (ref.expired())
+                return nullptr;
+            return CIntrusiveWeakPointer<T>(dynamic_cast<T*>(ref.get()));
+        }
+    }
+}
+
+template <typename T>
+struct std::hash<Hyprutils::Memory::CIntrusivePointer<T>> {
+    std::size_t operator()(const Hyprutils::Memory::CIntrusivePointer<T>& p) const noexcept {
+        return std::hash<const T*>{}(p.get());
+    }
+};
+
+template <typename T>
+struct std::hash<Hyprutils::Memory::CIntrusiveWeakPointer<T>> {
+    std::size_t operator()(const Hyprutils::Memory::CIntrusiveWeakPointer<T>& p) const noexcept {
+        return std::hash<void*>{}(p.m_block);
+    }
+};
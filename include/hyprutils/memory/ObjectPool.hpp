@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "ImplBase.hpp"
+#include "SharedPtr.hpp"
+#include "UniquePtr.hpp"
+
+/*
+    A typed object pool, handing out CSharedPointer / CUniquePointer whose objects,
+    together with their control blocks, live in contiguous slabs.
+
+    The pointers are regular ones. Once the last ref to a block is gone, its slot goes back
+    to the free list of its slab instead of to the allocator, and is handed out again by the next make.
+    Slabs are never given back while the pool is alive, call it a high water mark.
+
+    A pool can go before the objects it made, in that case each slab is freed with its last object.
+    Pools are not thread-safe, all makes and releases have to happen on one thread.
+*/
+
+namespace Hyprutils::Memory {
+    namespace Impl_ {
+        struct SSlab;
+
+        /* the type-erased part of CObjectPool, hands out fixed size slots */
+        class CSlabArena {
+          public:
+            /* slabs are this big, and aligned to it, so a slot can find its slab */
+            static constexpr size_t SLABSIZE = 64 * 1024;
+
+            CSlabArena(size_t slotSize, size_t slotAlign);
+            ~CSlabArena();
+
+            CSlabArena(const CSlabArena&)            = delete;
+            CSlabArena(CSlabArena&&)                 = delete;
+            CSlabArena& operator=(const CSlabArena&) = delete;
+            CSlabArena& operator=(CSlabArena&&)      = delete;
+
+            void*       alloc();
+
+            size_t      liveSlots() const;
+            size_t      slabCount() const;
+
+          private:
+            void                makeAvailable(SSlab* slab);
+
+            size_t              m_slotSize     = 0;
+            size_t              m_slotsOffset  = 0;
+            size_t              m_slotsPerSlab = 0;
+            size_t              m_live         = 0;
+
+            std::vector<SSlab*> m_slabs;
+            /* slabs with at least one free slot */
+            std::vector<SSlab*> m_available;
+
+            friend void freeSlabBlock(void* block) noexcept;
+        };
+    }
+
+    template <typename T>
+    class CObjectPool {
+      public:
+        CObjectPool() : m_arena(Impl_::inlineDataOffset<T>() + sizeof(T), std::max(alignof(T), alignof(Impl_::impl_base))) {
+            ;
+        }
+
+        CObjectPool(const CObjectPool&)            = delete;
+        CObjectPool(CObjectPool&&)                 = delete;
+        CObjectPool& operator=(const CObjectPool&) = delete;
+        CObjectPool& operator=(CObjectPool&&)      = delete;
+
+        template <typename... Args>
+        [[nodiscard]] CSharedPointer<T> makeShared(Args&&... args) {
+            auto* impl = make(true, std::forward<Args>(args)...);
+            return CSharedPointer<T>(impl, impl->getData());
+        }
+
+        template <typename... Args>
+        [[nodiscard]] CUniquePointer<T> makeUnique(Args&&... args) {
+            auto* impl = make(false, std::forward<Args>(args)...);
+            return CUniquePointer<T>(impl, impl->getData());
+        }
+
+        /* blocks handed out and not yet released. A block outlives its object while weak refs remain */
+        size_t live() const {
+            return m_arena.liveSlots();
+        }
+
+        size_t slabs() const {
+            return m_arena.slabCount();
+        }
+
+      private:
+        Impl_::CSlabArena m_arena;
+
+        /* same layout as Impl_::makeInline, only the storage differs */
+        template <typename... Args>
+        Impl_::impl_base* make(bool lockable, Args&&... args) {
+            auto* block = sc<unsigned char*>(m_arena.alloc());
+
+            T*    data = nullptr;
+            try {
+                data = ::new (block + Impl_::inlineDataOffset<T>()) T(std::forward<Args>(args)...);
+            } catch (...) {
+                Impl_::freeSlabBlock(block);
+                throw;
+            }
+
+            auto* impl = ::new (block) Impl_::impl_base(Impl_::dataPointer(data), Impl_::deleterIndex<&Impl_::destroyData<T>>(), lockable);
+            impl->setSizeClass(Impl_::SIZECLASS_SLAB);
+            Impl_::trackBlock<T>(impl);
+            return impl;
+        }
+    };
+}
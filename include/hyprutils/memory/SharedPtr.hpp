@@ -2,6 +2,7 @@
 #include <cstdint>
 
 #include "ImplBase.hpp"
+#include "DeferredDestruction.hpp"
 #include "Casts.hpp"
 
 /*
@@ -13,6 +14,10 @@
     namely in the fact that it keeps the T* inside the
     control block, and that you can still make a CWeakPtr
     or deref an existing one inside the destructor.
+
+    CSharedPointer<T[]> owns an array, made with makeShared<T[]>(size) or new T[size].
+    The aliasing constructor shares ownership of an object, but points at something else,
+    usually a member of it or an element of an array.
 */
 
 namespace Hyprutils {
@@ -26,37 +31,69 @@ namespace Hyprutils {
             template <typename X>
             using isConstructible = std::enable_if_t<std::is_constructible_v<T&, X&>>;
 
+            /* T, or the element type for T[] */
+            using element_type = std::remove_extent_t<T>;
+
+            /* how the refs are counted, see CSharedPointerFor */
+            using Counts = Impl_::SPlainCounts;
+
             /* creates a new shared pointer managing a resource
                avoid calling. Could duplicate ownership. Prefer makeShared */
-            explicit CSharedPointer(T* object) noexcept : impl_(new Impl_::impl_base(Impl_::dataPointer(object), _delete)), m_data(Impl_::dataPointer(object)) {
+            explicit CSharedPointer(element_type* object) noexcept :
+                impl_(Impl_::allocImpl(Impl_::dataPointer(object), Impl_::deleterIndex<&Impl_::deleteData<T>>())), m_data(Impl_::dataPointer(object)) {
+                Impl_::trackBlock<T>(impl_);
+                trackInstance();
+                increment();
+            }
+
+            /* aliasing: shares ownership with owner, but points at alias. No allocation.
+               Like the data of owner, the alias reads as empty once the owned object is gone. */
+            template <typename U>
+            CSharedPointer(const CSharedPointer<U>& owner, element_type* alias) noexcept : impl_(owner.impl_), m_data(Impl_::dataPointer(alias)) {
+                trackInstance();
                 increment();
             }
 
+            template <typename U>
+            CSharedPointer(CSharedPointer<U>&& owner, element_type* alias) noexcept : impl_(owner.impl_), m_data(Impl_::dataPointer(alias)) {
+                Impl_::untrackInstance(&owner.impl_);
+                trackInstance();
+                owner.impl_  = nullptr;
+                owner.m_data = nullptr;
+            }
+
             /* creates a shared pointer from a reference */
             template <typename U, typename = isConstructible<U>>
-            CSharedPointer(const CSharedPointer<U>& ref) noexcept : impl_(ref.impl_), m_data(Impl_::dataPointer(sc<T*>(ref.get()))) {
+            CSharedPointer(const CSharedPointer<U>& ref) noexcept : impl_(ref.impl_), m_data(Impl_::dataPointer(sc<element_type*>(ref.get()))) {
+                trackInstance();
                 increment();
             }
 
             CSharedPointer(const CSharedPointer& ref) noexcept : impl_(ref.impl_), m_data(ref.m_data) {
+                trackInstance();
                 increment();
             }
 
             template <typename U, typename = isConstructible<U>>
             CSharedPointer(CSharedPointer<U>&& ref) noexcept {
+                Impl_::untrackInstance(&ref.impl_);
                 impl_      = ref.impl_;
-                m_data     = Impl_::dataPointer(sc<T*>(ref.get()));
+                m_data     = Impl_::dataPointer(sc<element_type*>(ref.get()));
                 ref.impl_  = nullptr;
                 ref.m_data = nullptr;
+                trackInstance();
             }
 
             CSharedPointer(CSharedPointer&& ref) noexcept {
+                Impl_::untrackInstance(&ref.impl_);
                 std::swap(impl_, ref.impl_);
                 std::swap(m_data, ref.m_data);
+                trackInstance();
             }
 
             /* allows weakPointer to create from an impl */
             CSharedPointer(Impl_::impl_base* implementation, void* data) noexcept : impl_(implementation), m_data(data) {
+                trackInstance();
                 increment();
             }
 
@@ -69,19 +106,22 @@ namespace Hyprutils {
             }
 
             ~CSharedPointer() {
+                untrackInstance();
                 decrement(impl_);
             }
 
             template <typename U>
             validHierarchy<const CSharedPointer<U>&> operator=(const CSharedPointer<U>& rhs) {
                 if (impl_ == rhs.impl_) {
-                    m_data = Impl_::dataPointer(sc<T*>(rhs.get()));
+                    m_data = Impl_::dataPointer(sc<element_type*>(rhs.get()));
                     return *this;
                 }
 
+                untrackInstance();
                 decrement(impl_);
                 impl_  = rhs.impl_;
-                m_data = Impl_::dataPointer(sc<T*>(rhs.get()));
+                m_data = Impl_::dataPointer(sc<element_type*>(rhs.get()));
+                trackInstance();
                 increment();
                 return *this;
             }
@@ -90,9 +130,11 @@ namespace Hyprutils {
                 if (impl_ == rhs.impl_)
                     return *this;
 
+                untrackInstance();
                 decrement(impl_);
                 impl_  = rhs.impl_;
                 m_data = rhs.m_data;
+                trackInstance();
                 increment();
                 return *this;
             }
@@ -101,15 +143,23 @@ namespace Hyprutils {
             validHierarchy<const CSharedPointer<U>&> operator=(CSharedPointer<U>&& rhs) {
                 auto* rhsData = rhs.get();
 
+                untrackInstance();
+                Impl_::untrackInstance(&rhs.impl_);
                 std::swap(impl_, rhs.impl_);
                 std::swap(m_data, rhs.m_data);
-                m_data = Impl_::dataPointer(sc<T*>(rhsData));
+                m_data = Impl_::dataPointer(sc<element_type*>(rhsData));
+                trackInstance();
+                Impl_::trackInstance(&rhs.impl_);
                 return *this;
             }
 
             CSharedPointer& operator=(CSharedPointer&& rhs) noexcept {
+                untrackInstance();
+                Impl_::untrackInstance(&rhs.impl_);
                 std::swap(impl_, rhs.impl_);
                 std::swap(m_data, rhs.m_data);
+                trackInstance();
+                Impl_::trackInstance(&rhs.impl_);
                 return *this;
             }
 
@@ -139,23 +189,30 @@ namespace Hyprutils {
                 return rc<uintptr_t>(impl_) < rc<uintptr_t>(rhs.impl_);
             }
 
-            T* operator->() const {
+            element_type* operator->() const {
                 return get();
             }
 
-            T& operator*() const {
+            element_type& operator*() const {
                 return *get();
             }
 
+            element_type& operator[](std::ptrdiff_t idx) const
+                requires std::is_array_v<T>
+            {
+                return get()[idx];
+            }
+
             void reset() {
+                untrackInstance();
                 auto ptr = impl_;
                 impl_    = nullptr;
                 m_data   = nullptr;
                 decrement(ptr);
             }
 
-            T* get() const {
-                return impl_ && impl_->dataNonNull() ? sc<T*>(m_data) : nullptr;
+            element_type* get() const {
+                return impl_ && impl_->dataNonNull() ? sc<element_type*>(m_data) : nullptr;
             }
 
             unsigned int strongRef() const {
@@ -168,8 +225,13 @@ namespace Hyprutils {
             void* m_data = nullptr;
 
           private:
-            static void _delete(void* p) {
-                std::default_delete<T>{}(sc<T*>(p));
+            /* see Impl_::trackInstance, whenever impl_ changes */
+            void trackInstance() {
+                Impl_::trackInstance(&impl_);
+            }
+
+            void untrackInstance() noexcept {
+                Impl_::untrackInstance(&impl_);
             }
 
             /*
@@ -183,8 +245,13 @@ namespace Hyprutils {
 
                 base->dec();
 
-                // if ref == 0, we can destroy impl
-                if (base->ref() == 0)
+                if (base->ref() != 0)
+                    return;
+
+                // we can destroy impl, unless the thread wants it done later
+                if (Impl_::t_deferring)
+                    Impl_::retire(base);
+                else
                     destroyImpl(base);
             }
             /* no-op if there is no impl_ */
@@ -203,13 +270,35 @@ namespace Hyprutils {
 
                 // check for weak refs, if zero, we can also delete base
                 if (base->wref() == 0)
-                    delete base;
+                    Impl_::freeImpl(base);
             }
         };
 
+        /* allocates the object and its control block in one go, like std::make_shared.
+           Note: the storage is only released once the last weak pointer is gone. */
         template <typename U, typename... Args>
+            requires(!std::is_array_v<U>)
         [[nodiscard]] inline CSharedPointer<U> makeShared(Args&&... args) {
-            return CSharedPointer<U>(new U(std::forward<Args>(args)...));
+            if constexpr (!Impl_::canInline<U>())
+                return CSharedPointer<U>(new U(std::forward<Args>(args)...));
+            else {
+                auto* impl = Impl_::makeInline<U>(true, std::forward<Args>(args)...);
+                return CSharedPointer<U>(impl, impl->getData());
+            }
+        }
+
+        /* same for an array of size value-initialized elements */
+        template <typename U>
+            requires std::is_unbounded_array_v<U>
+        [[nodiscard]] inline CSharedPointer<U> makeShared(size_t size) {
+            using Element = std::remove_extent_t<U>;
+
+            if constexpr (!Impl_::canInline<Element>())
+                return CSharedPointer<U>(new Element[size]());
+            else {
+                auto* impl = Impl_::makeInlineArray<Element>(size);
+                return CSharedPointer<U>(impl, impl->getData());
+            }
         }
 
         template <typename T, typename U>
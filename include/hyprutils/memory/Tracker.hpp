@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/*
+    A leak and cycle tracker for the Hyprutils smart pointers.
+
+    It is compiled in with HYPRUTILS_TRACK_POINTERS, which has to be defined for the whole program
+    (the CMake option of the same name does that for everything linking to hyprutils).
+    Without it, none of the hooks below are called and the tracker sees nothing.
+
+    With it, every control block registers with its type, size and allocation backtrace,
+    and every CSharedPointer pointing into one registers where it lives. That is enough to tell which objects
+    are only kept alive by strong refs from other objects nothing else refers to, i.e. leaked through a cycle.
+
+    Registration is sharded, so threads rarely contend. For staging builds, setSampleRate() can
+    cut the overhead further: untracked objects only ever hide cycles, never make up false ones.
+    Pointers to blocks that were not sampled register nothing, they cost a flag check on the block.
+
+    An object spans sizeof() of the type it was handed to its first CSharedPointer as. For
+    CSharedPointer<Base>(new Derived), that is Base, so pointers living in the Derived part are not
+    seen as held by it, which can hide a cycle through them. makeShared<Derived>() records all of it.
+
+    The queries walk objects and pointers owned by other threads without synchronizing with them,
+    call them from the thread that owns the objects, or while the others are idle.
+*/
+
+namespace Hyprutils::Memory {
+    struct STrackedObject {
+        const void*        block = nullptr;
+        const void*        data  = nullptr;
+        std::string        type;
+        /* of the static type the block was made for, see above */
+        size_t             size   = 0;
+        uint32_t           strong = 0;
+        uint32_t           weak   = 0;
+        /* allocation backtrace, innermost first. May be empty */
+        std::vector<void*> site;
+    };
+
+    namespace Tracker {
+        /* whether this build of hyprutils was compiled with HYPRUTILS_TRACK_POINTERS */
+        bool compiledIn();
+
+        /* track one in every rate new control blocks, 1 tracks all (the default), 0 none */
+        void setSampleRate(uint32_t rate);
+
+        /* tracked objects that are still alive */
+        std::vector<STrackedObject> liveObjects();
+
+        /* groups of objects that keep each other alive, but are unreachable from anywhere else */
+        std::vector<std::vector<STrackedObject>> findCycles();
+
+        /* a human-readable report of the above */
+        std::string dump();
+    }
+
+    namespace Impl_ {
+        class impl_base;
+
+        void registerBlock(impl_base* impl, const std::type_info& type, size_t size);
+        void unregisterBlock(impl_base* impl) noexcept;
+
+        /* impl is the address of the impl_ member of a CSharedPointer */
+        void registerInstance(impl_base* const* impl);
+        void unregisterInstance(impl_base* const* impl) noexcept;
+
+        template <typename T>
+        void trackBlock(impl_base* impl) {
+#ifdef HYPRUTILS_TRACK_POINTERS
+            registerBlock(impl, typeid(T), sizeof(std::remove_extent_t<T>));
+#endif
+        }
+    }
+}
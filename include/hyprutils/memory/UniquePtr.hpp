@@ -23,7 +23,13 @@ namespace Hyprutils {
             /* creates a new unique pointer managing a resource
                avoid calling. Could duplicate ownership. Prefer makeUnique */
             explicit CUniquePointer(T* object) noexcept :
-                impl_(new Impl_::impl_base(Impl_::dataPointer(object), [](void* p) { std::default_delete<T>{}(sc<T*>(p)); }, false)), m_data(Impl_::dataPointer(object)) {
+                impl_(Impl_::allocImpl(Impl_::dataPointer(object), Impl_::deleterIndex<&Impl_::deleteData<T>>(), false)), m_data(Impl_::dataPointer(object)) {
+                Impl_::trackBlock<T>(impl_);
+                increment();
+            }
+
+            /* adopts a fresh control block with no refs yet, see CObjectPool */
+            CUniquePointer(Impl_::impl_base* implementation, void* data) noexcept : impl_(implementation), m_data(data) {
                 increment();
             }
 
@@ -156,7 +162,7 @@ namespace Hyprutils {
 
                 // check for weak refs, if zero, we can also delete impl_
                 if (impl_->wref() == 0) {
-                    delete impl_;
+                    Impl_::freeImpl(impl_);
                     impl_ = nullptr;
                 }
             }
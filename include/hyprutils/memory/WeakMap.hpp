@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "./WeakPtr.hpp"
+#include "./Casts.hpp"
+
+/*
+    A hash map keyed on weak pointers, by control block identity.
+
+    Entries whose key object is gone are evicted without anyone having to sweep them by hand:
+    lazily, whenever a lookup probes past one, and in full sweeps before the table would grow,
+    so the cost of the sweeps is amortized over the inserts.
+
+    As the map holds a weak ref to each key, a control block, and as such the identity of a key,
+    can't be reused while its entry is still around.
+
+    size() may count entries that expired but were not evicted yet, call prune() for an exact count.
+    The destructor of V must not touch the map it's in, it may run during any non-const call.
+*/
+
+namespace Hyprutils {
+    namespace Memory {
+        template <typename K, typename V>
+        class CWeakMap {
+          public:
+            CWeakMap() = default;
+
+            /* returns the value for key, or nullptr */
+            template <typename P>
+            V* find(const P& key) {
+                const auto IDX = findSlot(key.impl_);
+                return IDX == NOTFOUND ? nullptr : &m_slots[IDX]->value;
+            }
+
+            /* same as find, but without evicting anything */
+            template <typename P>
+            const V* find(const P& key) const {
+                if (!key.impl_ || m_slots.empty())
+                    return nullptr;
+
+                for (size_t i = idealSlot(key.impl_);; i = (i + 1) & mask()) {
+                    if (!m_slots[i])
+                        return nullptr;
+
+                    if (m_slots[i]->key.impl_ == key.impl_)
+                        return &m_slots[i]->value;
+                }
+            }
+
+            template <typename P>
+            bool contains(const P& key) const {
+                return find(key) != nullptr;
+            }
+
+            /* inserts V(args...) if key is not in the map yet. Returns the value, and whether it was inserted */
+            template <typename P, typename... Args>
+            std::pair<V*, bool> emplace(const P& key, Args&&... args) {
+                if (!key.impl_)
+                    return {nullptr, false};
+
+                if (const auto IDX = findSlot(key.impl_); IDX != NOTFOUND)
+                    return {&m_slots[IDX]->value, false};
+
+                reserveOneMore();
+
+                size_t i = idealSlot(key.impl_);
+                while (m_slots[i]) {
+                    i = (i + 1) & mask();
+                }
+
+                m_slots[i].emplace(CWeakPointer<K>(key), std::forward<Args>(args)...);
+                m_size++;
+                return {&m_slots[i]->value, true};
+            }
+
+            template <typename P>
+            V& operator[](const P& key) {
+                return *emplace(key).first;
+            }
+
+            template <typename P>
+            bool erase(const P& key) {
+                const auto IDX = findSlot(key.impl_);
+                if (IDX == NOTFOUND)
+                    return false;
+
+                eraseSlot(IDX);
+                return true;
+            }
+
+            /* calls fn(const CWeakPointer<K>&, V&) for every entry whose key is still alive */
+            template <typename F>
+            void forEach(F&& fn) {
+                for (auto& slot : m_slots) {
+                    if (slot && slot->key.valid())
+                        fn(slot->key, slot->value);
+                }
+            }
+
+            /* evicts every expired entry, returns how many */
+            size_t prune() {
+                size_t evicted = 0;
+
+                for (size_t i = 0; i < m_slots.size();) {
+                    // erasing shifts the next entry into i, look at it again
+                    if (m_slots[i] && !m_slots[i]->key.valid()) {
+                        eraseSlot(i);
+                        evicted++;
+                        continue;
+                    }
+
+                    ++i;
+                }
+
+                return evicted;
+            }
+
+            size_t size() const {
+                return m_size;
+            }
+
+            bool empty() const {
+                return m_size == 0;
+            }
+
+            void clear() {
+                m_slots.clear();
+                m_size = 0;
+            }
+
+          private:
+            struct SEntry {
+                CWeakPointer<K> key;
+                V               value;
+
+                template <typename... Args>
+                SEntry(CWeakPointer<K>&& key_, Args&&... args) : key(std::move(key_)), value(std::forward<Args>(args)...) {
+                    ;
+                }
+            };
+
+            static constexpr size_t            NOTFOUND    = SIZE_MAX;
+            static constexpr size_t            MINCAPACITY = 16;
+
+            std::vector<std::optional<SEntry>> m_slots;
+            size_t                             m_size = 0;
+
+            size_t                             mask() const {
+                return m_slots.size() - 1;
+            }
+
+            size_t idealSlot(const Impl_::impl_base* impl) const {
+                // fibonacci hashing, control blocks are aligned so the low bits would cluster
+                const uint64_t HASH = rc<uintptr_t>(impl) * 0x9E3779B97F4A7C15ULL;
+                return (HASH >> 32) & mask();
+            }
+
+            /* finds impl, evicting expired entries on the way */
+            size_t findSlot(const Impl_::impl_base* impl) {
+                if (!impl || m_slots.empty())
+                    return NOTFOUND;
+
+                for (size_t i = idealSlot(impl);;) {
+                    auto& slot = m_slots[i];
+                    if (!slot)
+                        return NOTFOUND;
+
+                    if (slot->key.impl_ == impl)
+                        return i;
+
+                    if (!slot->key.valid()) {
+                        // shifts the rest of the cluster back, look at i again
+                        eraseSlot(i);
+                        continue;
+                    }
+
+                    i = (i + 1) & mask();
+                }
+            }
+
+            /* backward shift deletion, keeps linear probing free of tombstones */
+            void eraseSlot(size_t hole) {
+                for (size_t i = (hole + 1) & mask(); m_slots[i]; i = (i + 1) & mask()) {
+                    const auto IDEAL = idealSlot(m_slots[i]->key.impl_);
+
+                    // stays if its ideal slot lies cyclically in (hole, i]
+                    const bool STAYS = hole <= i ? (hole < IDEAL && IDEAL <= i) : (hole < IDEAL || IDEAL <= i);
+                    if (STAYS)
+                        continue;
+
+                    m_slots[hole] = std::move(m_slots[i]);
+                    hole          = i;
+                }
+
+                m_slots[hole].reset();
+                m_size--;
+            }
+
+            /* grows at 3/4 load, but sweeps first. If that gets it below 1/2, there's no need to */
+            void reserveOneMore() {
+                if (m_slots.empty()) {
+                    m_slots.resize(MINCAPACITY);
+                    return;
+                }
+
+                if ((m_size + 1) * 4 <= m_slots.size() * 3)
+                    return;
+
+                prune();
+
+                if ((m_size + 1) * 2 <= m_slots.size())
+                    return;
+
+                rehash(m_slots.size() * 2);
+            }
+
+            void rehash(size_t capacity) {
+                auto old = std::move(m_slots);
+                m_slots  = std::vector<std::optional<SEntry>>(capacity);
+
+                for (auto& slot : old) {
+                    if (!slot || !slot->key.valid())
+                        continue;
+
+                    size_t i = idealSlot(slot->key.impl_);
+                    while (m_slots[i]) {
+                        i = (i + 1) & mask();
+                    }
+
+                    m_slots[i] = std::move(slot);
+                }
+
+                m_size = 0;
+                for (const auto& slot : m_slots) {
+                    m_size += !!slot;
+                }
+            }
+        };
+    }
+}
@@ -21,6 +21,12 @@ namespace Hyprutils {
             template <typename X>
             using isConstructible = std::enable_if_t<std::is_constructible_v<T&, X&>>;
 
+            /* T, or the element type for T[] */
+            using element_type = std::remove_extent_t<T>;
+
+            /* how the refs are counted, see CSharedPointerFor */
+            using Counts = Impl_::SPlainCounts;
+
             /* create a weak ptr from a reference */
             template <typename U, typename = isConstructible<U>>
             CWeakPointer(const CSharedPointer<U>& ref) noexcept {
@@ -28,7 +34,7 @@ namespace Hyprutils {
                     return;
 
                 impl_  = ref.impl_;
-                m_data = Impl_::dataPointer(sc<T*>(ref.get()));
+                m_data = Impl_::dataPointer(sc<element_type*>(ref.get()));
                 incrementWeak();
             }
 
@@ -39,7 +45,7 @@ namespace Hyprutils {
                     return;
 
                 impl_  = ref.impl_;
-                m_data = Impl_::dataPointer(sc<T*>(ref.get()));
+                m_data = Impl_::dataPointer(sc<element_type*>(ref.get()));
                 incrementWeak();
             }
 
@@ -50,7 +56,7 @@ namespace Hyprutils {
                     return;
 
                 impl_  = ref.impl_;
-                m_data = Impl_::dataPointer(sc<T*>(ref.get()));
+                m_data = Impl_::dataPointer(sc<element_type*>(ref.get()));
                 incrementWeak();
             }
 
@@ -74,7 +80,7 @@ namespace Hyprutils {
             template <typename U, typename = isConstructible<U>>
             CWeakPointer(CWeakPointer<U>&& ref) noexcept {
                 impl_      = ref.impl_;
-                m_data     = Impl_::dataPointer(sc<T*>(ref.get()));
+                m_data     = Impl_::dataPointer(sc<element_type*>(ref.get()));
                 ref.impl_  = nullptr;
                 ref.m_data = nullptr;
             }
@@ -88,13 +94,13 @@ namespace Hyprutils {
             template <typename U>
             validHierarchy<const CWeakPointer<U>&> operator=(const CWeakPointer<U>& rhs) {
                 if (impl_ == rhs.impl_) {
-                    m_data = Impl_::dataPointer(sc<T*>(rhs.get()));
+                    m_data = Impl_::dataPointer(sc<element_type*>(rhs.get()));
                     return *this;
                 }
 
                 decrementWeak();
                 impl_  = rhs.impl_;
-                m_data = Impl_::dataPointer(sc<T*>(rhs.get()));
+                m_data = Impl_::dataPointer(sc<element_type*>(rhs.get()));
                 incrementWeak();
                 return *this;
             }
@@ -116,7 +122,7 @@ namespace Hyprutils {
 
                 std::swap(impl_, rhs.impl_);
                 std::swap(m_data, rhs.m_data);
-                m_data = Impl_::dataPointer(sc<T*>(rhsData));
+                m_data = Impl_::dataPointer(sc<element_type*>(rhsData));
                 return *this;
             }
 
@@ -134,13 +140,13 @@ namespace Hyprutils {
             template <typename U>
             validHierarchy<const CWeakPointer<U>&> operator=(const CSharedPointer<U>& rhs) {
                 if (rc<uintptr_t>(impl_) == rc<uintptr_t>(rhs.impl_)) {
-                    m_data = Impl_::dataPointer(sc<T*>(rhs.get()));
+                    m_data = Impl_::dataPointer(sc<element_type*>(rhs.get()));
                     return *this;
                 }
 
                 decrementWeak();
                 impl_  = rhs.impl_;
-                m_data = Impl_::dataPointer(sc<T*>(rhs.get()));
+                m_data = Impl_::dataPointer(sc<element_type*>(rhs.get()));
                 incrementWeak();
                 return *this;
             }
@@ -219,15 +225,15 @@ namespace Hyprutils {
                 return rc<uintptr_t>(impl_) < rc<uintptr_t>(rhs.impl_);
             }
 
-            T* get() const {
-                return impl_ && impl_->dataNonNull() ? sc<T*>(m_data) : nullptr;
+            element_type* get() const {
+                return impl_ && impl_->dataNonNull() ? sc<element_type*>(m_data) : nullptr;
             }
 
-            T* operator->() const {
+            element_type* operator->() const {
                 return get();
             }
 
-            T& operator*() const {
+            element_type& operator*() const {
                 return *get();
             }
 
@@ -249,7 +255,7 @@ namespace Hyprutils {
                 // and have a shared_ptr destroy the same thing
                 // later (in situations where we have a weak_ptr to self)
                 if (impl_->wref() == 0 && impl_->ref() == 0 && !impl_->destroying()) {
-                    delete impl_;
+                    Impl_::freeImpl(impl_);
                     impl_ = nullptr;
                 }
             }
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "./Signal.hpp"
+#include "../os/FileDescriptor.hpp"
+
+/*
+    A signal that can be emitted from any thread, and is delivered on the thread owning it.
+
+    emit() copies the args into a bounded lock-free ring. The owner delivers them to the listeners
+    by calling dispatchPending(), usually once fd() polls readable, so it plugs right into an event loop.
+    Everything else, listening included, is owner thread only, like with any CSignalT.
+
+    The ring does not grow. Once it's full, emit() fails and returns false.
+*/
+
+namespace Hyprutils {
+    namespace Signal {
+        namespace Impl_ {
+            /* an eventfd, written at most once between two clears */
+            class CWakeup {
+              public:
+                CWakeup();
+
+                void                       notify();
+                void                       clear();
+
+                const OS::CFileDescriptor& fd() const;
+
+              private:
+                OS::CFileDescriptor m_fd;
+                std::atomic<bool>   m_notified = false;
+            };
+        }
+
+        template <typename... Args>
+        class CCrossThreadSignalT : public CSignalT<Args...> {
+            template <typename T>
+            using RefArg = typename CSignalT<Args...>::template RefArg<T>;
+
+          public:
+            /* capacity gets rounded up to a power of two */
+            explicit CCrossThreadSignalT(size_t capacity = 1024) {
+                size_t size = 2;
+                while (size < capacity) {
+                    size *= 2;
+                }
+
+                m_mask  = size - 1;
+                m_slots = std::make_unique<SSlot[]>(size);
+                for (size_t i = 0; i < size; ++i) {
+                    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            ~CCrossThreadSignalT() {
+                if (m_pDestroyed)
+                    *m_pDestroyed = true;
+
+                while (SQueued* queued = front()) {
+                    std::destroy_at(queued);
+                    pop();
+                }
+            }
+
+            CCrossThreadSignalT(const CCrossThreadSignalT&)            = delete;
+            CCrossThreadSignalT(CCrossThreadSignalT&&)                 = delete;
+            CCrossThreadSignalT& operator=(const CCrossThreadSignalT&) = delete;
+            CCrossThreadSignalT& operator=(CCrossThreadSignalT&&)      = delete;
+
+            /* thread-safe. Queues the args for the owner, returns false if the ring is full */
+            bool emit(RefArg<Args>... args) {
+                size_t pos  = m_enqueuePos.load(std::memory_order_relaxed);
+                SSlot* slot = nullptr;
+
+                while (true) {
+                    slot                = &m_slots[pos & m_mask];
+                    const size_t   SEQ  = slot->sequence.load(std::memory_order_acquire);
+                    const intptr_t DIFF = Memory::sc<intptr_t>(SEQ) - Memory::sc<intptr_t>(pos);
+
+                    if (DIFF == 0) {
+                        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    } else if (DIFF < 0)
+                        return false;
+                    else
+                        pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+
+                ::new (slot->storage) SQueued(args...);
+                slot->sequence.store(pos + 1, std::memory_order_release);
+
+                m_wakeup.notify();
+                return true;
+            }
+
+            /* owner thread only. Delivers what was queued when called, returns how many. Not reentrant */
+            size_t dispatchPending() {
+                if (m_pDestroyed)
+                    return 0;
+
+                m_wakeup.clear();
+
+                bool destroyed = false;
+                m_pDestroyed   = &destroyed;
+
+                // anything queued while dispatching waits for the next call, or this could go on forever
+                const size_t END        = m_enqueuePos.load(std::memory_order_acquire);
+                size_t       dispatched = 0;
+
+                while (m_dequeuePos != END) {
+                    SQueued* queued = front();
+                    if (!queued)
+                        break;
+
+                    // free the slot before the listeners run, producers can reuse it meanwhile
+                    SQueued args = std::move(*queued);
+                    std::destroy_at(queued);
+                    pop();
+
+                    std::apply([this](const auto&... unpacked) { this->emitArgs(false, unpacked...); }, args);
+                    dispatched++;
+
+                    // a listener destroyed us, don't touch anything
+                    if (destroyed)
+                        return dispatched;
+                }
+
+                m_pDestroyed = nullptr;
+                return dispatched;
+            }
+
+            /* readable while there's something to dispatch */
+            const OS::CFileDescriptor& fd() const {
+                return m_wakeup.fd();
+            }
+
+          private:
+            using SQueued = std::tuple<std::decay_t<Args>...>;
+
+            struct SSlot {
+                std::atomic<size_t> sequence = 0;
+                alignas(SQueued) unsigned char storage[sizeof(SQueued)];
+            };
+
+            /* the oldest queued args, nullptr if nothing is ready yet */
+            SQueued* front() {
+                SSlot& slot = m_slots[m_dequeuePos & m_mask];
+                if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1)
+                    return nullptr;
+
+                return std::launder(reinterpret_cast<SQueued*>(slot.storage));
+            }
+
+            void pop() {
+                m_slots[m_dequeuePos & m_mask].sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+                m_dequeuePos++;
+            }
+
+            std::unique_ptr<SSlot[]>        m_slots;
+            size_t                          m_mask = 0;
+
+            alignas(64) std::atomic<size_t> m_enqueuePos = 0;
+            // only touched by the owner
+            alignas(64) size_t m_dequeuePos = 0;
+
+            Impl_::CWakeup     m_wakeup;
+            // set while dispatching
+            bool* m_pDestroyed = nullptr;
+        };
+    }
+}
@@ -2,7 +2,10 @@
 
 #include <any>
 #include <functional>
+#include <tuple>
+#include <type_traits>
 #include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/Casts.hpp>
 
 namespace Hyprutils {
     namespace Signal {
@@ -17,16 +20,62 @@ namespace Hyprutils {
 
             [[deprecated("Relic of the legacy untyped signal API. Using this with CSignalT is undefined behavior.")]] void emit(std::any data);
 
-          private:
-            CSignalListener(std::function<void(void*)> handler);
+          protected:
+            /* unpacks the args of an emit, and calls the handler. Returns whether the handler consumed it */
+            using EmitFn = bool (*)(CSignalListener* self, void* args);
+
+            CSignalListener(EmitFn emit);
 
-            void                       emitInternal(void* args);
+          private:
+            bool   emitInternal(void* args);
 
-            std::function<void(void*)> m_fHandler;
+            EmitFn m_fEmit = nullptr;
+            // see CSignalBase, set when registered
+            int m_iPriority = 0;
 
             friend class CSignalBase;
         };
 
+        namespace Impl_ {
+            /*
+                A listener that keeps the concrete type of its handler, so an emit is a single indirect call
+                and the handler is not wrapped in any std::function. Made with makeShared, so the control block,
+                the listener and the handler are one allocation.
+            */
+            template <typename F, typename... Args>
+            class CTypedListener : public CSignalListener {
+              public:
+                template <typename Fn>
+                CTypedListener(Fn&& handler) : CSignalListener(&CTypedListener::emitTyped), m_handler(std::forward<Fn>(handler)) {
+                    ;
+                }
+
+              private:
+                static bool emitTyped(CSignalListener* self, void* args) {
+                    auto& handler = Memory::sc<CTypedListener*>(self)->m_handler;
+
+                    auto  call = [&]() -> decltype(auto) {
+                        if constexpr (sizeof...(Args) == 0)
+                            return std::invoke(handler);
+                        else if constexpr (sizeof...(Args) == 1)
+                            return std::invoke(handler, *Memory::sc<std::remove_reference_t<std::tuple_element_t<0, std::tuple<Args...>>>*>(args));
+                        else
+                            return std::apply(handler, *Memory::sc<std::tuple<Args...>*>(args));
+                    };
+
+                    // only a bool consumes, see CConsumableSignalT
+                    if constexpr (std::is_same_v<decltype(call()), bool>)
+                        return call();
+                    else {
+                        call();
+                        return false;
+                    }
+                }
+
+                F m_handler;
+            };
+        }
+
         typedef Hyprutils::Memory::CSharedPointer<CSignalListener> CHyprSignalListener;
     }
 }
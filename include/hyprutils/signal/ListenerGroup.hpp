@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "./Signal.hpp"
+
+/*
+    Owns many listeners, possibly on many signals, and drops them all at once.
+
+    The listeners are bump-allocated next to each other, behind a single control block that they all share.
+    Signals keep a weak ref to that block for each listener, so clearing the group expires all of them
+    with one decrement, and a signal can drop all the entries of a group in one pass with disconnect().
+
+    The first few listeners fit in the block itself, the rest go in chunks of their own.
+    Only the block outlives clear() while signals still hold stale refs, so it's kept small.
+*/
+
+namespace Hyprutils {
+    namespace Signal {
+        namespace Impl_ {
+            class CListenerArena {
+              public:
+                CListenerArena() = default;
+                ~CListenerArena();
+
+                CListenerArena(const CListenerArena&)            = delete;
+                CListenerArena(CListenerArena&&)                 = delete;
+                CListenerArena& operator=(const CListenerArena&) = delete;
+                CListenerArena& operator=(CListenerArena&&)      = delete;
+
+                template <typename L, typename... CtorArgs>
+                L* make(CtorArgs&&... args) {
+                    void* node     = allocate(sizeof(SNode), alignof(SNode));
+                    L*    listener = ::new (allocate(sizeof(L), alignof(L))) L(std::forward<CtorArgs>(args)...);
+
+                    m_pLast = ::new (node) SNode{
+                        .prev     = m_pLast,
+                        .listener = listener,
+                        .destroy  = [](CSignalListener* l) { std::destroy_at(Memory::sc<L*>(l)); },
+                    };
+                    m_iCount++;
+
+                    return listener;
+                }
+
+                size_t size() const {
+                    return m_iCount;
+                }
+
+              private:
+                // a few small listeners, with their nodes
+                static constexpr size_t INLINESIZE = 256;
+
+                // placed before each listener, destroys it
+                struct SNode {
+                    SNode*           prev     = nullptr;
+                    CSignalListener* listener = nullptr;
+                    void (*destroy)(CSignalListener*) = nullptr;
+                };
+
+                void* allocate(size_t size, size_t align);
+
+                alignas(std::max_align_t) std::byte m_inline[INLINESIZE];
+                std::byte*                         m_pCursor = m_inline;
+                std::byte*                         m_pEnd    = m_inline + INLINESIZE;
+                // once the inline storage is full, each chunk twice the previous
+                std::vector<std::unique_ptr<std::byte[]>> m_vChunks;
+                size_t                                     m_iNextChunk = INLINESIZE;
+
+                SNode*                                     m_pLast  = nullptr;
+                size_t                                     m_iCount = 0;
+            };
+        }
+
+        class CListenerGroup {
+          public:
+            CListenerGroup() = default;
+
+            CListenerGroup(const CListenerGroup&)            = delete;
+            CListenerGroup(CListenerGroup&&)                 = default;
+            CListenerGroup& operator=(const CListenerGroup&) = delete;
+            CListenerGroup& operator=(CListenerGroup&&)      = default;
+
+            /* like CSignalT::listen, but the listener lives as long as the group */
+            template <typename F, typename... Args>
+                requires(std::is_invocable_v<F&, CSignalT<>::RefArg<Args>...> || (sizeof...(Args) != 0 && std::is_invocable_v<F&>))
+            void listen(CSignalT<Args...>& signal, F&& handler, int priority = 0) {
+                if constexpr (std::is_invocable_v<F&, CSignalT<>::RefArg<Args>...>) {
+                    if (!m_arena)
+                        m_arena = Memory::makeShared<Impl_::CListenerArena>();
+
+                    auto* listener = m_arena->make<Impl_::CTypedListener<std::decay_t<F>, CSignalT<>::RefArg<Args>...>>(std::forward<F>(handler));
+                    signal.registerListenerInternal(CHyprSignalListener(m_arena, listener), priority);
+                } else
+                    listen(signal, [handler = std::forward<F>(handler)](CSignalT<>::RefArg<Args>...) mutable -> decltype(auto) { return std::invoke(handler); }, priority);
+            }
+
+            /* destroys every listener of the group. Handlers that are running finish first */
+            void clear() {
+                m_arena.reset();
+            }
+
+            size_t size() const {
+                return m_arena ? m_arena->size() : 0;
+            }
+
+            bool empty() const {
+                return size() == 0;
+            }
+
+          private:
+            Memory::CSharedPointer<Impl_::CListenerArena> m_arena;
+
+            friend class CSignalBase;
+        };
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./Signal.hpp"
+
+/*
+    A signal that collects emits, and delivers them to its listeners in a batch once its owner calls flush().
+    Listening works like with any other CSignalT, emit() only queues a copy of the args.
+
+    Optionally, emits can be coalesced: emits with the same key replace each other while queued,
+    so only the latest args for each key get delivered, in the place of the first emit with that key.
+
+    Emits during a flush are queued for the next one. Emits through a CSignalT&, e.g. as the target of forward(),
+    are not queued but delivered right away.
+*/
+
+namespace Hyprutils {
+    namespace Signal {
+        template <typename... Args>
+        class CQueuedSignalT : public CSignalT<Args...> {
+            template <typename T>
+            using RefArg = typename CSignalT<Args...>::template RefArg<T>;
+
+          public:
+            using KeyFn = std::function<size_t(RefArg<Args>...)>;
+
+            CQueuedSignalT() = default;
+
+            ~CQueuedSignalT() {
+                if (m_pDestroyed)
+                    *m_pDestroyed = true;
+            }
+
+            CQueuedSignalT(const CQueuedSignalT&)            = delete;
+            CQueuedSignalT(CQueuedSignalT&&)                 = delete;
+            CQueuedSignalT& operator=(const CQueuedSignalT&) = delete;
+            CQueuedSignalT& operator=(CQueuedSignalT&&)      = delete;
+
+            /* queues the args for the next flush */
+            void emit(RefArg<Args>... args) {
+                if (m_fKey) {
+                    const auto KEY = m_fKey(args...);
+
+                    if (const auto IT = m_mKeyIndex.find(KEY); IT != m_mKeyIndex.end()) {
+                        m_vQueue[IT->second] = SQueued(args...);
+                        return;
+                    }
+
+                    m_mKeyIndex.emplace(KEY, m_vQueue.size());
+                }
+
+                m_vQueue.emplace_back(args...);
+            }
+
+            /* delivers everything queued. Not reentrant: a flush from a listener does nothing */
+            void flush() {
+                if (m_pDestroyed || m_vQueue.empty())
+                    return;
+
+                // the buffers swap roles, so a steady flow of emits doesn't allocate
+                auto batch = std::move(m_vQueue);
+                m_vQueue   = std::move(m_vSpare);
+                m_mKeyIndex.clear();
+
+                bool destroyed = false;
+                m_pDestroyed   = &destroyed;
+
+                for (const auto& args : batch) {
+                    std::apply([this](const auto&... unpacked) { this->emitArgs(false, unpacked...); }, args);
+
+                    // a listener destroyed us, don't touch anything
+                    if (destroyed)
+                        return;
+                }
+
+                m_pDestroyed = nullptr;
+
+                batch.clear();
+                m_vSpare = std::move(batch);
+            }
+
+            /* emits with the same key replace each other while queued. An empty fn turns coalescing off */
+            void coalesceBy(KeyFn key) {
+                m_fKey = std::move(key);
+                m_mKeyIndex.clear();
+
+                for (size_t i = 0; m_fKey && i < m_vQueue.size(); ++i) {
+                    m_mKeyIndex.try_emplace(std::apply(m_fKey, m_vQueue[i]), i);
+                }
+            }
+
+            /* all emits replace each other, only the latest one is delivered */
+            void coalesceAll() {
+                m_vQueue.erase(m_vQueue.begin(), m_vQueue.end() - std::min<size_t>(m_vQueue.size(), 1));
+                coalesceBy([](RefArg<Args>...) -> size_t { return 0; });
+            }
+
+            /* drops everything queued */
+            void clear() {
+                m_vQueue.clear();
+                m_mKeyIndex.clear();
+            }
+
+            size_t pending() const {
+                return m_vQueue.size();
+            }
+
+          private:
+            using SQueued = std::tuple<std::decay_t<Args>...>;
+
+            std::vector<SQueued>               m_vQueue;
+            std::vector<SQueued>               m_vSpare;
+            KeyFn                              m_fKey;
+            // key -> index in m_vQueue, only with a key fn
+            std::unordered_map<size_t, size_t> m_mKeyIndex;
+            // set while flushing
+            bool* m_pDestroyed = nullptr;
+        };
+    }
+}
@@ -10,50 +10,111 @@
 #include <hyprutils/memory/SharedPtr.hpp>
 #include <hyprutils/memory/WeakPtr.hpp>
 #include "./Listener.hpp"
+#include "./Stats.hpp"
+
+/*
+    Listeners run by priority, higher first. Listeners of the same priority run in the order they were registered,
+    regular ones before static ones.
+
+    In a CConsumableSignalT, a listener returning true consumes the event, which stops the dispatch.
+*/
 
 namespace Hyprutils {
     namespace Signal {
+        class CListenerGroup;
+
         class CSignalBase {
+          public:
+            CSignalBase() = default;
+            ~CSignalBase();
+
+            CSignalBase(const CSignalBase& other);
+            CSignalBase(CSignalBase&& other) noexcept;
+            CSignalBase& operator=(const CSignalBase& other);
+            CSignalBase& operator=(CSignalBase&& other) noexcept;
+
+            /* tags the signal for Stats.hpp, signals with the same name share their stats. No-op without HYPRUTILS_SIGNAL_STATS */
+            void setName(const std::string& name);
+
+            /* drops the entries of every listener in the group at once. They stay registered with other signals */
+            void disconnect(const CListenerGroup& group);
+
           protected:
-            CHyprSignalListener                                             registerListenerInternal(std::function<void(void*)> handler);
-            void                                                            registerStaticListenerInternal(std::function<void(void*)> handler);
-            void                                                            emitInternal(void* args);
+            CHyprSignalListener                                             registerListenerInternal(CHyprSignalListener listener, int priority = 0);
+            void                                                            registerStaticListenerInternal(CHyprSignalListener listener, int priority = 0);
+            /* returns whether a listener consumed it, which only happens if consumable */
+            bool                                                            emitInternal(void* args, bool consumable = false);
+            /* emits have to reach emitInternal() even without listeners, to be counted */
+            bool                                                            instrumented() const {
+#ifdef HYPRUTILS_SIGNAL_STATS
+                return m_pStats;
+#else
+                return false;
+#endif
+            }
 
             std::vector<Hyprutils::Memory::CWeakPointer<CSignalListener>>   m_vListeners;
             std::vector<Hyprutils::Memory::CSharedPointer<CSignalListener>> m_vStaticListeners;
+
+          private:
+            struct SEmitFrame;
+
+            void sweepListeners();
+            void sortListeners();
+
+            // innermost running emit, if any. Gets the listeners if we die during it
+            SEmitFrame* m_pEmitFrame = nullptr;
+            // size of m_vListeners at which registering sweeps stale entries
+            size_t m_iNextSweep = 0;
+            // listeners were appended out of order during an emit
+            bool m_bUnsorted = false;
+#ifdef HYPRUTILS_SIGNAL_STATS
+            // set by setName(), outlives us
+            Impl_::SStatsRecord* m_pStats = nullptr;
+#endif
+
+            friend class CListenerGroup;
         };
 
         template <typename... Args>
         class CSignalT : public CSignalBase {
+          protected:
             template <typename T>
             using RefArg = std::conditional_t<std::is_trivially_copyable_v<T>, T, const T&>;
 
-          public:
-            void emit(RefArg<Args>... args) {
-                if (m_vListeners.empty() && m_vStaticListeners.empty())
-                    return;
+            bool emitArgs(bool consumable, RefArg<Args>... args) {
+                if (m_vListeners.empty() && m_vStaticListeners.empty() && !instrumented())
+                    return false;
 
                 if constexpr (sizeof...(Args) == 0)
-                    emitInternal(nullptr);
+                    return emitInternal(nullptr, consumable);
                 else {
                     auto argsTuple = std::tuple<RefArg<Args>...>(args...);
 
                     if constexpr (sizeof...(Args) == 1)
                         // NOLINTNEXTLINE: const is reapplied by handler invocation if required
-                        emitInternal(Memory::cc<void*>(Memory::sc<const void*>(&std::get<0>(argsTuple))));
+                        return emitInternal(Memory::cc<void*>(Memory::sc<const void*>(&std::get<0>(argsTuple))), consumable);
                     else
-                        emitInternal(&argsTuple);
+                        return emitInternal(&argsTuple, consumable);
                 }
             }
 
-            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(std::function<void(RefArg<Args>...)> handler) {
-                return registerListenerInternal(mkHandler(handler));
+          public:
+            void emit(RefArg<Args>... args) {
+                emitArgs(false, args...);
+            }
+
+            /* handler is any callable taking the args of the signal, or none at all. Higher priorities run first */
+            template <typename F>
+                requires std::is_invocable_v<F&, RefArg<Args>...>
+            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(F&& handler, int priority = 0) {
+                return registerListenerInternal(mkListener(std::forward<F>(handler)), priority);
             }
 
-            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(std::function<void()> handler)
-                requires(sizeof...(Args) != 0)
-            {
-                return listen([handler](RefArg<Args>... args) { handler(); });
+            template <typename F>
+                requires(sizeof...(Args) != 0 && std::is_invocable_v<F&> && !std::is_invocable_v<F&, RefArg<Args>...>)
+            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(F&& handler, int priority = 0) {
+                return listen([handler = std::forward<F>(handler)](RefArg<Args>... args) mutable -> decltype(auto) { return std::invoke(handler); }, priority);
             }
 
             template <typename... OtherArgs>
@@ -73,14 +134,16 @@ namespace Hyprutils {
             }
 
             // this is for static listeners. They die with this signal.
-            void listenStatic(std::function<void(RefArg<Args>...)> handler) {
-                registerStaticListenerInternal(mkHandler(handler));
+            template <typename F>
+                requires std::is_invocable_v<F&, RefArg<Args>...>
+            void listenStatic(F&& handler, int priority = 0) {
+                registerStaticListenerInternal(mkListener(std::forward<F>(handler)), priority);
             }
 
-            void listenStatic(std::function<void()> handler)
-                requires(sizeof...(Args) != 0)
-            {
-                return listenStatic([handler](RefArg<Args>... args) { handler(); });
+            template <typename F>
+                requires(sizeof...(Args) != 0 && std::is_invocable_v<F&> && !std::is_invocable_v<F&, RefArg<Args>...>)
+            void listenStatic(F&& handler, int priority = 0) {
+                return listenStatic([handler = std::forward<F>(handler)](RefArg<Args>... args) mutable -> decltype(auto) { return std::invoke(handler); }, priority);
             }
 
             // Deprecated: use listenStatic()
@@ -92,15 +155,27 @@ namespace Hyprutils {
             }
 
           private:
-            std::function<void(void*)> mkHandler(std::function<void(RefArg<Args>...)> handler) {
-                return [handler](void* args) {
-                    if constexpr (sizeof...(Args) == 0)
-                        handler();
-                    else if constexpr (sizeof...(Args) == 1)
-                        handler(*Memory::sc<std::remove_reference_t<std::tuple_element_t<0, std::tuple<RefArg<Args>...>>>*>(args));
-                    else
-                        std::apply(handler, *Memory::sc<std::tuple<RefArg<Args>...>*>(args));
-                };
+            template <typename F>
+            CHyprSignalListener mkListener(F&& handler) {
+                return Memory::makeShared<Impl_::CTypedListener<std::decay_t<F>, RefArg<Args>...>>(std::forward<F>(handler));
+            }
+
+            friend class CListenerGroup;
+        };
+
+        /*
+            A signal whose listeners can stop the dispatch by returning true, e.g. input routing stopping at the first consumer.
+            Listeners returning anything else, or nothing, never consume.
+        */
+        template <typename... Args>
+        class CConsumableSignalT : public CSignalT<Args...> {
+            template <typename T>
+            using RefArg = typename CSignalT<Args...>::template RefArg<T>;
+
+          public:
+            /* returns whether a listener consumed it */
+            bool emit(RefArg<Args>... args) {
+                return this->emitArgs(true, args...);
             }
         };
 
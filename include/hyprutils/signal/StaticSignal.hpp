@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+/*
+    A signal whose listeners are fixed at compile time: Handlers are function pointers, or member function pointers of Owner,
+    and each is called with the owner given at construction, followed by the args of the emit.
+
+    There is no listener storage, and the handlers are direct calls the compiler can inline, so an emit costs what calling them does.
+    Nothing can listen to it at runtime, use CSignalT for that.
+
+    It is meant for wiring that is fixed for good, like a component notifying its own parts,
+    e.g. animated variables telling their CAnimationManager they started or stopped animating.
+    Hooks that are part of an API, e.g. the connect and disconnect signals of CAnimationManager, stay CSignalT:
+    turning them into one would stop everyone else from listening.
+*/
+
+namespace Hyprutils {
+    namespace Signal {
+        template <typename Owner, auto... Handlers>
+        class CStaticSignalT {
+          public:
+            explicit CStaticSignalT(Owner* owner) : m_pOwner(owner) {
+                ;
+            }
+
+            /* calls the handlers in order. The args are passed as lvalues, so none of them can steal them from the next */
+            template <typename... Args>
+                requires(std::is_invocable_v<decltype(Handlers), Owner*, Args&...> && ...)
+            void emit(Args&&... args) const {
+                (std::invoke(Handlers, m_pOwner, args...), ...);
+            }
+
+          private:
+            Owner* m_pOwner = nullptr;
+        };
+    }
+}
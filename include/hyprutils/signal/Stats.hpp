@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+    Instrumentation for signals: how often they are emitted, to how many listeners, and how long dispatching takes.
+
+    It is compiled in with HYPRUTILS_SIGNAL_STATS, which has to be defined for the whole program
+    (the CMake option of the same name does that for everything linking to hyprutils).
+    Without it, there is nothing in the signals to pay for, and setName() does nothing.
+
+    With it, only signals given a name with CSignalBase::setName() are recorded. Signals sharing a name share
+    their stats, so e.g. the same signal of every window adds up to one entry.
+    Counts are exact, but only one in every setSampleRate() emits is timed, which keeps the clock off the hot path.
+    Dispatch times include whatever the listeners did, nested emits too.
+*/
+
+namespace Hyprutils::Signal {
+    struct SSignalStats {
+        std::string name;
+        uint64_t    emits = 0;
+        /* emits that were timed, the times below cover only these */
+        uint64_t timedEmits = 0;
+        /* listeners alive as of the latest emit */
+        size_t                   listeners = 0;
+        std::chrono::nanoseconds totalDispatch{0};
+        std::chrono::nanoseconds maxDispatch{0};
+    };
+
+    namespace Stats {
+        /* whether this build of hyprutils was compiled with HYPRUTILS_SIGNAL_STATS */
+        bool compiledIn();
+
+        /* time one in every rate emits, 1 times all (the default), 0 none */
+        void setSampleRate(uint32_t rate);
+
+        /* every named signal, the most total dispatch time first. Safe to call from any thread */
+        std::vector<SSignalStats> snapshot();
+
+        /* zeroes all the stats, names stay registered */
+        void reset();
+    }
+
+    namespace Impl_ {
+        struct SStatsRecord;
+
+        /* the record for a name, created on first use. Records are never freed */
+        SStatsRecord* statsRecord(const std::string& name);
+        /* counts the emit. Returns when it started, or 0 if it's not timed */
+        uint64_t beginEmit(SStatsRecord* record) noexcept;
+        void     endEmit(SStatsRecord* record, uint64_t start, size_t listeners) noexcept;
+    }
+}
@@ -38,16 +38,14 @@ void CBaseAnimatedVariable::connectToActive() {
     if (m_bDummy || m_bIsConnectedToActive || isAnimationManagerDead())
         return;
 
-    m_pSignals->connect.emit(m_pSelf);
-    m_bIsConnectedToActive = true;
+    m_pAnimationManager->m_activeSignals.connect.emit(this);
 }
 
 void CBaseAnimatedVariable::disconnectFromActive() {
     if (isAnimationManagerDead())
         return;
 
-    m_pSignals->disconnect.emit(m_pSelf);
-    m_bIsConnectedToActive = false;
+    m_pAnimationManager->m_activeSignals.disconnect.emit(this);
 }
 
 bool Hyprutils::Animation::CBaseAnimatedVariable::enabled() const {
@@ -84,51 +82,63 @@ float CBaseAnimatedVariable::getCurveValue() const {
     if (!m_bIsBeingAnimated || isAnimationManagerDead())
         return 1.F;
 
-    if (isSpringCurve())
+    // branch on what was resolved, the config may have changed in place since
+    resolveCurve();
+    if (m_pSpring)
         return m_fSpringValue;
 
-    const auto BEZIER = m_pAnimationManager->getBezier(getBezierName());
-    if (!BEZIER)
+    if (!m_pBezier)
         return 1.F;
 
     const auto SPENT = getPercent();
     if (SPENT >= 1.F)
         return 1.F;
 
-    return BEZIER->getYForPoint(SPENT);
+    return m_pBezier->getYForPoint(SPENT);
 }
 
 CBaseAnimatedVariable::SCurveStepResult CBaseAnimatedVariable::getCurveStep() {
     if (!m_bIsBeingAnimated || isAnimationManagerDead())
         return {};
 
-    if (!isSpringCurve()) {
-        const auto SPENT = getPercent();
-        if (SPENT >= 1.f)
-            return {.value = 1.F, .finished = true};
+    resolveCurve();
+    if (m_pSpring)
+        return springStep(*m_pSpring, std::chrono::steady_clock::now());
 
-        const auto BEZIER = m_pAnimationManager->getBezier(getBezierName());
-        if (!BEZIER)
-            return {.value = 1.F, .finished = true};
+    const auto SPENT = getPercent();
+    if (SPENT >= 1.f || !m_pBezier)
+        return {.value = 1.F, .finished = true};
 
-        return {
-            .value    = BEZIER->getYForPoint(SPENT),
-            .finished = false,
-        };
-    }
+    return {
+        .value    = m_pBezier->getYForPoint(SPENT),
+        .finished = false,
+    };
+}
 
-    const auto SPRINGNAME = springNameFromSpec(getBezierName());
-    const auto SPRING     = m_pAnimationManager->getSpring(std::string{SPRINGNAME});
-    if (!SPRING)
-        return {.value = 1.F, .finished = true};
+void CBaseAnimatedVariable::resolveCurve() const {
+    if (m_iCurveGeneration == m_pAnimationManager->m_iCurveGeneration)
+        return;
+
+    m_iCurveGeneration = m_pAnimationManager->m_iCurveGeneration;
+
+    const auto& NAME       = getBezierName();
+    const auto  SPRINGNAME = springNameFromSpec(NAME);
+    if (SPRINGNAME.empty()) {
+        m_pBezier = m_pAnimationManager->getBezier(NAME);
+        m_pSpring.reset();
+    } else {
+        m_pBezier.reset();
+        m_pSpring = m_pAnimationManager->getSpring(std::string{SPRINGNAME});
+    }
+}
 
-    const auto NOW = std::chrono::steady_clock::now();
-    const auto DT  = NOW - springLastStep;
-    springLastStep = NOW;
+CBaseAnimatedVariable::SCurveStepResult CBaseAnimatedVariable::springStep(const SSpringCurve& spring, std::chrono::steady_clock::time_point now) {
+    const auto DT  = now - springLastStep;
+    springLastStep = now;
 
-    advanceSpring(m_fSpringValue, m_fSpringVelocity, *SPRING, DT);
+    advanceSpring(m_fSpringValue, m_fSpringVelocity, spring, DT);
 
-    const bool FINISHED = std::abs(1.F - m_fSpringValue) <= SPRING->valueEpsilon && std::abs(m_fSpringVelocity) <= SPRING->velocityEpsilon;
+    const bool FINISHED = std::abs(1.F - m_fSpringValue) <= spring.valueEpsilon && std::abs(m_fSpringVelocity) <= spring.velocityEpsilon;
     if (FINISHED) {
         m_fSpringValue    = 1.F;
         m_fSpringVelocity = 0.F;
@@ -195,6 +205,8 @@ void CBaseAnimatedVariable::onAnimationBegin(bool preserveCurveState, float spri
 
     m_bIsBeingAnimated = true;
     animationBegin     = std::chrono::steady_clock::now();
+    // the config may have changed in place, look the curve up again
+    m_iCurveGeneration = 0;
     connectToActive();
 
     if (m_fBeginCallback) {
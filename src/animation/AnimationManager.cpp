@@ -20,24 +20,51 @@ CAnimationManager::CAnimationManager() {
     m_mBezierCurves["default"] = BEZIER;
     m_mSpringCurves["default"] = makeShared<SSpringCurve>(DEFAULTSPRING);
 
-    m_events    = makeUnique<SAnimationManagerSignals>();
-    m_listeners = makeUnique<SAnimVarListeners>();
+    m_events = makeUnique<SAnimationManagerSignals>();
+}
+
+void CAnimationManager::onConnect(CBaseAnimatedVariable* animVar) {
+    if (!m_bTickScheduled)
+        scheduleTick();
+
+    animVar->m_bIsConnectedToActive = true;
+    animVar->m_iActiveIndex         = m_vActiveAnimatedVariables.size();
+    m_vActiveAnimatedVariables.emplace_back(animVar->m_pSelf);
+
+    m_events->connect.emit(animVar->m_pSelf);
+}
 
-    m_listeners->connect = m_events->connect.listen([this](const WP<CBaseAnimatedVariable>& animVar) {
-        if (!m_bTickScheduled)
-            scheduleTick();
+void CAnimationManager::onDisconnect(CBaseAnimatedVariable* animVar) {
+    if (!animVar->m_bIsConnectedToActive)
+        return;
+
+    animVar->m_bIsConnectedToActive = false;
+
+    // the list is public, if someone else moved things around, look for it the slow way
+    const size_t IDX = animVar->m_iActiveIndex;
+    if (IDX >= m_vActiveAnimatedVariables.size() || m_vActiveAnimatedVariables[IDX].impl_ != animVar->m_pSelf.impl_)
+        std::erase_if(m_vActiveAnimatedVariables, [animVar](const auto& other) { return other.impl_ == animVar->m_pSelf.impl_; });
+    else {
+        // the last one takes its place. It's connected, so alive: a variable disconnects when it dies
+        if (IDX != m_vActiveAnimatedVariables.size() - 1) {
+            m_vActiveAnimatedVariables[IDX] = std::move(m_vActiveAnimatedVariables.back());
+            if (const auto MOVED = m_vActiveAnimatedVariables[IDX].get())
+                MOVED->m_iActiveIndex = IDX;
+        }
+
+        m_vActiveAnimatedVariables.pop_back();
+    }
 
-        if (animVar)
-            m_vActiveAnimatedVariables.emplace_back(animVar);
-    });
+    m_events->disconnect.emit(animVar->m_pSelf);
+}
 
-    m_listeners->disconnect = m_events->disconnect.listen([this](const WP<CBaseAnimatedVariable>& animVar) {
-        if (animVar)
-            std::erase_if(m_vActiveAnimatedVariables, [&](const auto& other) { return !other || other == animVar; });
-    });
+void CAnimationManager::curvesChanged() {
+    if (++m_iCurveGeneration == 0)
+        m_iCurveGeneration = 1;
 }
 
 void CAnimationManager::removeAllBeziers() {
+    curvesChanged();
     m_mBezierCurves.clear();
 
     // add the default one
@@ -47,6 +74,7 @@ void CAnimationManager::removeAllBeziers() {
 }
 
 void CAnimationManager::removeAllSprings() {
+    curvesChanged();
     m_mSpringCurves.clear();
     m_mSpringCurves["default"] = makeShared<SSpringCurve>(DEFAULTSPRING);
 }
@@ -55,16 +83,109 @@ void CAnimationManager::addBezierWithName(std::string name, const Vector2D& p1,
     const auto BEZIER = makeShared<CBezierCurve>();
     BEZIER->setup({p1, p2});
     m_mBezierCurves[name] = BEZIER;
+    curvesChanged();
 }
 
 void CAnimationManager::addSpringWithName(std::string name, const SSpringCurve& spring) {
     m_mSpringCurves[name] = makeShared<SSpringCurve>(spring);
+    curvesChanged();
 }
 
 bool CAnimationManager::shouldTickForNext() {
     return !m_vActiveAnimatedVariables.empty();
 }
 
+static int64_t beginNs(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(begin.time_since_epoch()).count();
+}
+
+CBaseAnimatedVariable* CAnimationManager::batchEntryVar(const SBatchEntry& entry) const {
+    if (entry.index >= m_vActiveAnimatedVariables.size() || m_vActiveAnimatedVariables[entry.index].get() != entry.var)
+        return nullptr;
+
+    // a variable that died and was replaced at the same address is caught here too
+    if (!entry.var->isBeingAnimated() || beginNs(entry.var->animationBegin) != entry.begin)
+        return nullptr;
+
+    return entry.var;
+}
+
+void CAnimationManager::updateActive() {
+    auto&      batch = m_updateBatch;
+
+    const auto NOW   = std::chrono::steady_clock::now();
+    const auto NOWNS = beginNs(NOW);
+
+    // gather. Most variables share their curve with the previous one
+    uint32_t lastCurve = 0;
+
+    for (size_t i = 0; i < m_vActiveAnimatedVariables.size(); ++i) {
+        auto* const PAV = m_vActiveAnimatedVariables[i].get();
+        if (!PAV || !PAV->m_bInterpolatable || !PAV->isBeingAnimated())
+            continue;
+
+        const SBatchEntry ENTRY = {.index = sc<uint32_t>(i), .var = PAV, .begin = beginNs(PAV->animationBegin)};
+
+        PAV->resolveCurve();
+        if (PAV->m_pSpring) {
+            batch.springs.emplace_back(ENTRY);
+            continue;
+        }
+
+        if (batch.curves.empty() || !(batch.curves[lastCurve] == PAV->m_pBezier)) {
+            const auto IT = std::ranges::find(batch.curves, PAV->m_pBezier);
+            lastCurve     = IT - batch.curves.begin();
+            if (IT == batch.curves.end())
+                batch.curves.emplace_back(PAV->m_pBezier);
+        }
+
+        batch.vars.emplace_back(ENTRY);
+        // a disabled variable, or one without a config, warps like in update(). The speed doesn't matter
+        batch.speed.emplace_back(PAV->enabled() ? PAV->m_pConfig->pValues->internalSpeed : 1.F);
+        batch.curve.emplace_back(lastCurve);
+    }
+
+    const size_t COUNT = batch.vars.size();
+    batch.progress.resize(COUNT);
+    batch.value.resize(COUNT);
+
+    // progress, like getPercent(): whole milliseconds, a tenth of a second per unit of speed
+    for (size_t i = 0; i < COUNT; ++i) {
+        const float MS    = sc<float>((NOWNS - batch.vars[i].begin) / 1000000);
+        batch.progress[i] = std::clamp((MS / 100.F) / batch.speed[i], 0.F, 1.F);
+    }
+
+    for (size_t i = 0; i < COUNT; ++i) {
+        const auto& CURVE = batch.curves[batch.curve[i]];
+        batch.value[i]    = batch.progress[i] >= 1.F || !CURVE ? 1.F : CURVE->getYForPoint(batch.progress[i]);
+    }
+
+    // apply. Callbacks can do anything, so every variable is checked again. One moved or restarted catches up next frame
+    for (size_t i = 0; i < COUNT; ++i) {
+        auto* const PAV = batchEntryVar(batch.vars[i]);
+        if (!PAV || PAV->warpIfSettled())
+            continue;
+
+        PAV->applyCurveStep({.value = batch.value[i], .finished = batch.progress[i] >= 1.F || !batch.curves[batch.curve[i]]});
+    }
+
+    // springs carry state, they are stepped one by one, and only if there's something left to animate
+    for (const auto& entry : batch.springs) {
+        auto* const PAV = batchEntryVar(entry);
+        if (!PAV || PAV->warpIfSettled())
+            continue;
+
+        PAV->resolveCurve();
+        PAV->applyCurveStep(PAV->m_pSpring ? PAV->springStep(*PAV->m_pSpring, NOW) : CBaseAnimatedVariable::SCurveStepResult{});
+    }
+
+    batch.vars.clear();
+    batch.speed.clear();
+    batch.curve.clear();
+    batch.curves.clear();
+    batch.springs.clear();
+}
+
 void CAnimationManager::tickDone() {
     rotateActive();
 }
@@ -76,9 +197,10 @@ void CAnimationManager::rotateActive() {
         if (!av)
             continue;
 
-        if (av->ok() && av->isBeingAnimated())
+        if (av->ok() && av->isBeingAnimated()) {
+            av->m_iActiveIndex = active.size();
             active.emplace_back(av);
-        else
+        } else
             av->m_bIsConnectedToActive = false;
     }
 
@@ -104,13 +226,13 @@ bool CAnimationManager::springExists(const std::string& spring) {
 }
 
 SP<CBezierCurve> CAnimationManager::getBezier(const std::string& name) {
-    const auto BEZIER = std::ranges::find_if(m_mBezierCurves, [&](const auto& other) { return other.first == name; });
+    const auto BEZIER = m_mBezierCurves.find(name);
 
     return BEZIER == m_mBezierCurves.end() ? m_mBezierCurves["default"] : BEZIER->second;
 }
 
 SP<SSpringCurve> CAnimationManager::getSpring(const std::string& name) {
-    const auto SPRING = std::ranges::find_if(m_mSpringCurves, [&](const auto& other) { return other.first == name; });
+    const auto SPRING = m_mSpringCurves.find(name);
 
     return SPRING == m_mSpringCurves.end() ? m_mSpringCurves["default"] : SPRING->second;
 }
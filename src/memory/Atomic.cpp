@@ -0,0 +1,15 @@
+#include <hyprutils/memory/Atomic.hpp>
+
+#include <array>
+#include <cstdint>
+
+using namespace Hyprutils::Memory;
+
+static constexpr size_t                          STRIPES = 64;
+
+static std::array<std::recursive_mutex, STRIPES> g_stripes;
+
+std::recursive_mutex& Hyprutils::Memory::Atomic_::legacyMutex(const void* block) noexcept {
+    // the low bits are the same for every block, skip them
+    return g_stripes[(reinterpret_cast<uintptr_t>(block) >> 4) % STRIPES];
+}
@@ -0,0 +1,263 @@
+#include <hyprutils/memory/ControlBlockPool.hpp>
+#include <hyprutils/memory/ImplBase.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+
+using namespace Hyprutils::Memory;
+
+// sizeClass N is SIZECLASSES[N - 1], 0 means the block did not come from the pool
+static constexpr std::array<size_t, 7> SIZECLASSES = {32, 48, 64, 96, 128, 192, 256};
+// max blocks cached per class and thread
+static constexpr size_t MAXCACHED = 4096;
+
+static std::atomic<bool> g_enabled = false;
+
+namespace {
+    // the stats of one thread, only ever written by it, so counting needs no atomic RMW.
+    // Never freed, reused with its counts once its thread is gone, stats() sums them all up
+    struct alignas(64) SStatsRecord {
+        std::atomic<size_t> liveBlocks = 0;
+        std::atomic<size_t> hits       = 0;
+        std::atomic<size_t> misses     = 0;
+        std::atomic<bool>   inUse      = true;
+        SStatsRecord*       next       = nullptr;
+    };
+
+    struct SFreeBlock {
+        SFreeBlock* next = nullptr;
+    };
+
+    struct SFreeList {
+        SFreeBlock* head  = nullptr;
+        size_t      count = 0;
+    };
+
+    // with HYPRLAND_DEBUG, every block handed out and not freed yet
+    struct SLiveBlocks {
+        std::mutex                      mutex;
+        std::unordered_set<const void*> blocks;
+    };
+
+    struct SThreadCache {
+        std::array<SFreeList, SIZECLASSES.size()> lists;
+        SStatsRecord*                             stats = nullptr;
+
+        void                                      trim() {
+            for (auto& list : lists) {
+                while (list.head) {
+                    auto* next = list.head->next;
+                    ::operator delete(list.head);
+                    list.head = next;
+                }
+
+                list.count = 0;
+            }
+        }
+
+        ~SThreadCache();
+    };
+}
+
+static std::atomic<SStatsRecord*> g_statsRecords = nullptr;
+// frees of pooled blocks after the cache of their thread is gone
+static std::atomic<size_t> g_lateFrees = 0;
+// what resetStats() saw, stats() counts from there
+static std::atomic<size_t>       g_hitsBase = 0, g_missesBase = 0;
+
+static thread_local ePoolMode    t_mode = POOL_MODE_INHERIT;
+// set once the cache below is gone, frees during thread teardown must not touch it
+static thread_local bool         t_cacheDead = false;
+static thread_local SThreadCache t_cache;
+
+SThreadCache::~SThreadCache() {
+    trim();
+    t_cacheDead = true;
+
+    if (stats)
+        stats->inUse.store(false, std::memory_order_release);
+}
+
+static SStatsRecord* acquireStatsRecord() {
+    for (auto* r = g_statsRecords.load(std::memory_order_acquire); r; r = r->next) {
+        bool expected = false;
+        if (r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return r;
+    }
+
+    auto* r = new SStatsRecord;
+    r->next = g_statsRecords.load(std::memory_order_relaxed);
+    while (!g_statsRecords.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+        ;
+    }
+
+    return r;
+}
+
+static SStatsRecord& threadStats() {
+    if (!t_cache.stats)
+        t_cache.stats = acquireStatsRecord();
+
+    return *t_cache.stats;
+}
+
+// the owner is the only writer. Wraps around for a negative delta, the sum comes out right
+static void bump(std::atomic<size_t>& counter, size_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// never freed, blocks go away during static destruction as well
+[[maybe_unused]] static SLiveBlocks& liveBlocks() {
+    static auto* live = new SLiveBlocks;
+    return *live;
+}
+
+static uint8_t sizeClassFor(size_t size) {
+    for (size_t i = 0; i < SIZECLASSES.size(); ++i) {
+        if (size <= SIZECLASSES[i])
+            return i + 1;
+    }
+
+    return 0;
+}
+
+void Hyprutils::Memory::ControlBlockPool::setEnabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Hyprutils::Memory::ControlBlockPool::setThreadMode(ePoolMode mode) {
+    t_mode = mode;
+}
+
+bool Hyprutils::Memory::ControlBlockPool::enabled() {
+    if (t_mode == POOL_MODE_INHERIT)
+        return g_enabled.load(std::memory_order_relaxed);
+
+    return t_mode == POOL_MODE_ENABLED;
+}
+
+// counts since the start, of every thread
+static SControlBlockPoolStats sumStats() {
+    SControlBlockPoolStats sum;
+
+    for (auto* r = g_statsRecords.load(std::memory_order_acquire); r; r = r->next) {
+        sum.liveBlocks += r->liveBlocks.load(std::memory_order_relaxed);
+        sum.hits += r->hits.load(std::memory_order_relaxed);
+        sum.misses += r->misses.load(std::memory_order_relaxed);
+    }
+
+    sum.liveBlocks -= g_lateFrees.load(std::memory_order_relaxed);
+    return sum;
+}
+
+SControlBlockPoolStats Hyprutils::Memory::ControlBlockPool::stats() {
+    auto stats = sumStats();
+    stats.hits -= g_hitsBase.load(std::memory_order_relaxed);
+    stats.misses -= g_missesBase.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Hyprutils::Memory::ControlBlockPool::resetStats() {
+    // live blocks are not a statistic, but state. Leave them be.
+    const auto STATS = sumStats();
+    g_hitsBase.store(STATS.hits, std::memory_order_relaxed);
+    g_missesBase.store(STATS.misses, std::memory_order_relaxed);
+}
+
+void Hyprutils::Memory::ControlBlockPool::trim() {
+    if (!t_cacheDead)
+        t_cache.trim();
+}
+
+static void* allocPooled(size_t size, uint8_t& sizeClass) {
+    sizeClass = 0;
+
+    if (!ControlBlockPool::enabled() || t_cacheDead)
+        return ::operator new(size);
+
+    const auto CLASS = sizeClassFor(size);
+    if (CLASS == 0)
+        return ::operator new(size);
+
+    sizeClass   = CLASS;
+    auto& stats = threadStats();
+    bump(stats.liveBlocks, 1);
+
+    auto& list = t_cache.lists[CLASS - 1];
+    if (list.head) {
+        auto* block = list.head;
+        list.head   = block->next;
+        list.count--;
+        bump(stats.hits, 1);
+        return block;
+    }
+
+    bump(stats.misses, 1);
+    return ::operator new(SIZECLASSES[CLASS - 1]);
+}
+
+void* Hyprutils::Memory::Impl_::allocBlock(size_t size, uint8_t& sizeClass) {
+    void* block = allocPooled(size, sizeClass);
+    markBlock(block, true);
+    return block;
+}
+
+void Hyprutils::Memory::Impl_::freeBlock(void* block, uint8_t sizeClass) noexcept {
+    markBlock(block, false);
+
+    if (sizeClass == SIZECLASS_SLAB) {
+        freeSlabBlock(block);
+        return;
+    }
+
+    if (sizeClass == 0) {
+        ::operator delete(block);
+        return;
+    }
+
+    if (t_cacheDead)
+        g_lateFrees.fetch_add(1, std::memory_order_relaxed);
+    else
+        bump(threadStats().liveBlocks, -1);
+
+    if (!ControlBlockPool::enabled() || t_cacheDead) {
+        ::operator delete(block);
+        return;
+    }
+
+    auto& list = t_cache.lists[sizeClass - 1];
+    if (list.count >= MAXCACHED) {
+        ::operator delete(block);
+        return;
+    }
+
+    list.head = ::new (block) SFreeBlock{.next = list.head};
+    list.count++;
+}
+
+void Hyprutils::Memory::Impl_::markBlock(void* block, bool live) noexcept {
+#ifdef HYPRLAND_DEBUG
+    auto&                       blocks = liveBlocks();
+    std::lock_guard<std::mutex> lg(blocks.mutex);
+
+    if (live)
+        blocks.blocks.emplace(block);
+    else
+        blocks.blocks.erase(block);
+#endif
+}
+
+bool Hyprutils::Memory::Impl_::dataAlive(impl_base* impl) noexcept {
+#ifdef HYPRLAND_DEBUG
+    // under the lock, so the block can't be freed between the lookup and the read
+    auto&                       blocks = liveBlocks();
+    std::lock_guard<std::mutex> lg(blocks.mutex);
+
+    return blocks.blocks.contains(impl) && impl->dataNonNull();
+#else
+    return impl->dataNonNull();
+#endif
+}
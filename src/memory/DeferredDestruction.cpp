@@ -0,0 +1,65 @@
+#include <hyprutils/memory/DeferredDestruction.hpp>
+#include <hyprutils/memory/ImplBase.hpp>
+
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    struct SRetireList {
+        std::vector<Impl_::impl_base*> list;
+        // entries before this one have been destroyed already
+        size_t head = 0;
+
+        size_t drain(size_t max) {
+            size_t destroyed = 0;
+
+            // destructors may retire more, which may reallocate the list. Hence no iterators.
+            while (head < list.size() && destroyed < max) {
+                auto* impl = list[head++];
+
+                impl->destroy();
+                if (impl->wref() == 0)
+                    Impl_::freeImpl(impl);
+
+                destroyed++;
+            }
+
+            if (head == list.size()) {
+                list.clear();
+                head = 0;
+            }
+
+            return destroyed;
+        }
+
+        ~SRetireList() {
+            // nothing may be retired anymore, cascades are destroyed right away
+            Impl_::t_deferring = false;
+            drain(SIZE_MAX);
+        }
+    };
+}
+
+static thread_local SRetireList t_retired;
+
+void Hyprutils::Memory::DeferredDestruction::setEnabled(bool enabled) {
+    Impl_::t_deferring = enabled;
+}
+
+bool Hyprutils::Memory::DeferredDestruction::enabled() {
+    return Impl_::t_deferring;
+}
+
+size_t Hyprutils::Memory::DeferredDestruction::pending() {
+    return t_retired.list.size() - t_retired.head;
+}
+
+size_t Hyprutils::Memory::DeferredDestruction::drain(size_t max) {
+    return t_retired.drain(max);
+}
+
+void Hyprutils::Memory::Impl_::retire(impl_base* impl) {
+    impl->setRetired();
+    t_retired.list.emplace_back(impl);
+}
@@ -0,0 +1,157 @@
+#include <hyprutils/memory/Epoch.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    // one per thread that ever pinned. Never freed, reused once their thread is gone.
+    struct alignas(64) SEpochRecord {
+        // global epoch at the time of pinning, 0 if not pinned
+        std::atomic<uint64_t> epoch = 0;
+        std::atomic<bool>     inUse = true;
+        SEpochRecord*         next  = nullptr;
+    };
+
+    struct SRetired {
+        void*            obj   = nullptr;
+        Impl_::ReclaimFn fn    = nullptr;
+        uint64_t         epoch = 0;
+    };
+
+    struct SRetiredList {
+        std::mutex            mutex;
+        std::vector<SRetired> list;
+
+        ~SRetiredList() {
+            // no one is reading anymore at exit
+            for (auto& r : list) {
+                r.fn(r.obj);
+            }
+        }
+    };
+
+    struct SThreadRecord {
+        SEpochRecord* record = nullptr;
+        size_t        depth  = 0;
+
+        ~SThreadRecord() {
+            if (record)
+                record->inUse.store(false, std::memory_order_release);
+        }
+    };
+}
+
+static std::atomic<uint64_t>      g_epoch   = 1;
+static std::atomic<SEpochRecord*> g_records = nullptr;
+static std::atomic<size_t>        g_pending = 0;
+
+static SRetiredList&              retiredList() {
+    static SRetiredList list;
+    return list;
+}
+
+static thread_local SThreadRecord t_record;
+
+static SEpochRecord*              acquireRecord() {
+    for (auto* r = g_records.load(std::memory_order_acquire); r; r = r->next) {
+        bool expected = false;
+        if (r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return r;
+    }
+
+    auto* r = new SEpochRecord;
+    r->next = g_records.load(std::memory_order_relaxed);
+    while (!g_records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+        ;
+    }
+
+    return r;
+}
+
+// lowest epoch any reader is pinned at, UINT64_MAX if none is
+static uint64_t minPinnedEpoch() {
+    uint64_t min = UINT64_MAX;
+    for (auto* r = g_records.load(std::memory_order_acquire); r; r = r->next) {
+        const auto EPOCH = r->epoch.load(std::memory_order_acquire);
+        if (EPOCH != 0 && EPOCH < min)
+            min = EPOCH;
+    }
+
+    return min;
+}
+
+CEpochGuard::CEpochGuard() {
+    if (t_record.depth++ > 0)
+        return;
+
+    if (!t_record.record)
+        t_record.record = acquireRecord();
+
+    t_record.record->epoch.store(g_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    // pairs with the fence in epochDefer: either we see the strong count at zero,
+    // or the one who dropped it sees us pinned
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+CEpochGuard::~CEpochGuard() {
+    if (--t_record.depth > 0)
+        return;
+
+    t_record.record->epoch.store(0, std::memory_order_release);
+
+    if (g_pending.load(std::memory_order_relaxed) != 0)
+        Epoch::collect();
+}
+
+size_t Hyprutils::Memory::Epoch::collect() {
+    std::vector<SRetired> reclaimable;
+
+    {
+        auto&                       retired = retiredList();
+        std::lock_guard<std::mutex> lg(retired.mutex);
+
+        const auto                  MIN = minPinnedEpoch();
+
+        std::erase_if(retired.list, [&](const SRetired& r) {
+            if (r.epoch >= MIN)
+                return false;
+
+            reclaimable.emplace_back(r);
+            return true;
+        });
+
+        g_pending.store(retired.list.size(), std::memory_order_relaxed);
+    }
+
+    // outside of the lock, these can drop more refs
+    for (auto& r : reclaimable) {
+        r.fn(r.obj);
+    }
+
+    return reclaimable.size();
+}
+
+size_t Hyprutils::Memory::Epoch::pending() {
+    return g_pending.load(std::memory_order_relaxed);
+}
+
+bool Hyprutils::Memory::Impl_::epochDefer(void* obj, ReclaimFn fn) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (minPinnedEpoch() == UINT64_MAX)
+        return false;
+
+    // readers pinned from now on are past this epoch, and will see the strong count at zero
+    const auto                  EPOCH = g_epoch.fetch_add(1, std::memory_order_seq_cst);
+
+    auto&                       retired = retiredList();
+    std::lock_guard<std::mutex> lg(retired.mutex);
+    retired.list.emplace_back(SRetired{.obj = obj, .fn = fn, .epoch = EPOCH});
+    g_pending.store(retired.list.size(), std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,65 @@
+#include <hyprutils/memory/ImplBase.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+using namespace Hyprutils::Memory;
+using namespace Hyprutils::Memory::Impl_;
+
+// the table grows in chunks, so entries never move and lookups need no lock
+static constexpr size_t CHUNKSIZE = 4096;
+static constexpr size_t MAXCHUNKS = 256;
+
+namespace {
+    using SChunk = std::array<DeleteFn, CHUNKSIZE>;
+}
+
+static std::array<std::atomic<SChunk*>, MAXCHUNKS> g_chunks;
+static std::mutex                                  g_registerMutex;
+// 0 is reserved for "no deleter"
+static uint32_t g_nextIndex = 1;
+
+uint32_t Hyprutils::Memory::Impl_::registerDeleter(DeleteFn fn) {
+    std::lock_guard<std::mutex> lg(g_registerMutex);
+
+    const auto                  INDEX = g_nextIndex;
+    const auto                  CHUNK = INDEX / CHUNKSIZE;
+
+    if (CHUNK >= MAXCHUNKS)
+        throw std::length_error("Hyprutils::Memory: too many deleter types");
+
+    auto* chunk = g_chunks[CHUNK].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new SChunk{};
+        g_chunks[CHUNK].store(chunk, std::memory_order_release);
+    }
+
+    (*chunk)[INDEX % CHUNKSIZE] = fn;
+    g_nextIndex++;
+    return INDEX;
+}
+
+DeleteFn Hyprutils::Memory::Impl_::deleterFor(uint32_t index) noexcept {
+    // whoever holds an index got it from registerDeleter, which is ordered before any block using it
+    auto* chunk = g_chunks[index / CHUNKSIZE].load(std::memory_order_acquire);
+    if (!chunk)
+        return nullptr;
+
+    return (*chunk)[index % CHUNKSIZE];
+}
+
+uint16_t Hyprutils::Memory::Impl_::threadToken() noexcept {
+    static std::atomic<uint16_t> nextToken = 1;
+
+    thread_local const uint16_t  TOKEN = [] {
+        // 0 means unclaimed, skip it on wraparound. A collision only costs a missed trap
+        uint16_t token = nextToken.fetch_add(1, std::memory_order_relaxed);
+        if (token == 0)
+            token = nextToken.fetch_add(1, std::memory_order_relaxed);
+        return token;
+    }();
+
+    return TOKEN;
+}
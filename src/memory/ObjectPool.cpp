@@ -0,0 +1,132 @@
+#include <hyprutils/memory/ObjectPool.hpp>
+#include <hyprutils/memory/Casts.hpp>
+#include <hyprutils/misc/HyprAssert.hpp>
+
+#include <new>
+#include <stdexcept>
+
+using namespace Hyprutils::Memory;
+using namespace Hyprutils::Memory::Impl_;
+
+namespace Hyprutils::Memory::Impl_ {
+    struct SFreeSlot {
+        SFreeSlot* next = nullptr;
+    };
+
+    // lives at the start of every slab, the slots follow
+    struct SSlab {
+        // nullptr once the arena is gone, the slab then goes with its last slot
+        CSlabArena* arena    = nullptr;
+        SFreeSlot*  freeList = nullptr;
+        // slots past this one were never handed out
+        size_t untouched = 0;
+        size_t live      = 0;
+        bool   available = false;
+#ifdef HYPRLAND_DEBUG
+        // the thread that made the slab, the only one allowed to touch it
+        uint16_t thread = threadToken();
+#endif
+    };
+}
+
+// pools are not thread-safe, with HYPRLAND_DEBUG, using one from two threads traps. See impl_base::checkThread
+static void checkThread(const SSlab* slab) {
+#ifdef HYPRLAND_DEBUG
+    HYPRUTILS_ASSERT_MSG(slab->thread == threadToken(), "a CObjectPool, or a pointer made by one, was used across threads");
+#endif
+}
+
+static SSlab* slabOf(void* slot) {
+    return rc<SSlab*>(rc<uintptr_t>(slot) & ~(CSlabArena::SLABSIZE - 1));
+}
+
+static void freeSlab(SSlab* slab) {
+    slab->~SSlab();
+    ::operator delete(slab, std::align_val_t{CSlabArena::SLABSIZE});
+}
+
+CSlabArena::CSlabArena(size_t slotSize, size_t slotAlign) {
+    // a free slot holds the free list link
+    slotSize       = std::max(slotSize, sizeof(SFreeSlot));
+    m_slotSize     = (slotSize + slotAlign - 1) & ~(slotAlign - 1);
+    m_slotsOffset  = (sizeof(SSlab) + slotAlign - 1) & ~(slotAlign - 1);
+    m_slotsPerSlab = m_slotsOffset < SLABSIZE ? (SLABSIZE - m_slotsOffset) / m_slotSize : 0;
+
+    if (m_slotsPerSlab < 4)
+        throw std::invalid_argument("Hyprutils::Memory::CObjectPool: type too large to pool");
+}
+
+CSlabArena::~CSlabArena() {
+    for (auto* slab : m_slabs) {
+        if (slab->live == 0)
+            freeSlab(slab);
+        else
+            slab->arena = nullptr;
+    }
+}
+
+void* CSlabArena::alloc() {
+    while (!m_available.empty()) {
+        auto* slab = m_available.back();
+        checkThread(slab);
+
+        void* slot = nullptr;
+        if (slab->freeList) {
+            slot           = slab->freeList;
+            slab->freeList = slab->freeList->next;
+        } else if (slab->untouched < m_slotsPerSlab)
+            slot = rc<unsigned char*>(slab) + m_slotsOffset + (slab->untouched++ * m_slotSize);
+
+        if (!slab->freeList && slab->untouched >= m_slotsPerSlab) {
+            slab->available = false;
+            m_available.pop_back();
+        }
+
+        if (!slot)
+            continue;
+
+        slab->live++;
+        m_live++;
+        markBlock(slot, true);
+        return slot;
+    }
+
+    auto* slab = ::new (::operator new(SLABSIZE, std::align_val_t{SLABSIZE})) SSlab{.arena = this};
+    m_slabs.emplace_back(slab);
+    makeAvailable(slab);
+
+    return alloc();
+}
+
+void CSlabArena::makeAvailable(SSlab* slab) {
+    if (slab->available)
+        return;
+
+    slab->available = true;
+    m_available.emplace_back(slab);
+}
+
+size_t CSlabArena::liveSlots() const {
+    return m_live;
+}
+
+size_t CSlabArena::slabCount() const {
+    return m_slabs.size();
+}
+
+void Hyprutils::Memory::Impl_::freeSlabBlock(void* block) noexcept {
+    auto* slab = slabOf(block);
+    checkThread(slab);
+
+    slab->freeList = ::new (block) SFreeSlot{.next = slab->freeList};
+    slab->live--;
+
+    if (!slab->arena) {
+        if (slab->live == 0)
+            freeSlab(slab);
+        return;
+    }
+
+    slab->arena->m_live--;
+    slab->arena->makeAvailable(slab);
+}
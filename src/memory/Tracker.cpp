@@ -0,0 +1,316 @@
+#include <hyprutils/memory/Tracker.hpp>
+#include <hyprutils/memory/ImplBase.hpp>
+#include <hyprutils/memory/Casts.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <format>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define HAS_BACKTRACE 1
+#endif
+
+using namespace Hyprutils::Memory;
+
+static constexpr size_t SHARDS    = 64;
+static constexpr size_t MAXFRAMES = 8;
+
+namespace {
+    struct SBlockEntry {
+        const std::type_info*        type = nullptr;
+        size_t                       size = 0;
+        std::array<void*, MAXFRAMES> frames{};
+        uint8_t                      frameCount = 0;
+    };
+
+    struct alignas(64) SBlockShard {
+        std::mutex                                               mutex;
+        std::unordered_map<const Impl_::impl_base*, SBlockEntry> blocks;
+    };
+
+    struct alignas(64) SInstanceShard {
+        std::mutex                                   mutex;
+        std::unordered_set<Impl_::impl_base* const*> instances;
+    };
+}
+
+static std::array<SBlockShard, SHARDS>    g_blockShards;
+static std::array<SInstanceShard, SHARDS> g_instanceShards;
+static std::atomic<uint32_t>              g_sampleRate    = 1;
+static thread_local uint32_t              t_sampleCounter = 0;
+
+static size_t                             shardFor(const void* p) {
+    // blocks and pointers are at least 8-aligned, the low bits carry nothing
+    return (rc<uintptr_t>(p) >> 4) % SHARDS;
+}
+
+static std::string demangle(const std::type_info& type) {
+    int   status    = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status != 0 || !demangled)
+        return type.name();
+
+    std::string result = demangled;
+    std::free(demangled);
+    return result;
+}
+
+bool Hyprutils::Memory::Tracker::compiledIn() {
+#ifdef HYPRUTILS_TRACK_POINTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Hyprutils::Memory::Tracker::setSampleRate(uint32_t rate) {
+    g_sampleRate.store(rate, std::memory_order_relaxed);
+}
+
+void Hyprutils::Memory::Impl_::registerBlock(impl_base* impl, const std::type_info& type, size_t size) {
+    const auto RATE = g_sampleRate.load(std::memory_order_relaxed);
+    if (RATE == 0 || ++t_sampleCounter % RATE != 0)
+        return;
+
+    // from here on, pointers to it register too
+    impl->setTracked();
+
+    SBlockEntry entry{.type = &type, .size = size};
+
+#ifdef HAS_BACKTRACE
+    // + 1 for ourselves
+    std::array<void*, MAXFRAMES + 1> frames;
+    const int                        COUNT = backtrace(frames.data(), frames.size());
+    if (COUNT > 1) {
+        entry.frameCount = COUNT - 1;
+        std::copy_n(frames.begin() + 1, entry.frameCount, entry.frames.begin());
+    }
+#endif
+
+    auto&                       shard = g_blockShards[shardFor(impl)];
+    std::lock_guard<std::mutex> lg(shard.mutex);
+    shard.blocks.insert_or_assign(impl, entry);
+}
+
+void Hyprutils::Memory::Impl_::unregisterBlock(impl_base* impl) noexcept {
+    auto&                       shard = g_blockShards[shardFor(impl)];
+    std::lock_guard<std::mutex> lg(shard.mutex);
+    shard.blocks.erase(impl);
+}
+
+void Hyprutils::Memory::Impl_::registerInstance(impl_base* const* impl) {
+    auto&                       shard = g_instanceShards[shardFor(impl)];
+    std::lock_guard<std::mutex> lg(shard.mutex);
+    shard.instances.emplace(impl);
+}
+
+void Hyprutils::Memory::Impl_::unregisterInstance(impl_base* const* impl) noexcept {
+    auto&                       shard = g_instanceShards[shardFor(impl)];
+    std::lock_guard<std::mutex> lg(shard.mutex);
+    shard.instances.erase(impl);
+}
+
+std::vector<STrackedObject> Hyprutils::Memory::Tracker::liveObjects() {
+    std::vector<STrackedObject> objects;
+
+    for (auto& shard : g_blockShards) {
+        std::lock_guard<std::mutex> lg(shard.mutex);
+
+        for (const auto& [block, entry] : shard.blocks) {
+            auto* impl = cc<Impl_::impl_base*>(block);
+            if (!impl->dataNonNull())
+                continue;
+
+            objects.emplace_back(STrackedObject{
+                .block  = block,
+                .data   = impl->getData(),
+                .type   = demangle(*entry.type),
+                .size   = entry.size,
+                .strong = impl->ref(),
+                .weak   = impl->wref(),
+                .site   = std::vector<void*>(entry.frames.begin(), entry.frames.begin() + entry.frameCount),
+            });
+        }
+    }
+
+    return objects;
+}
+
+std::vector<std::vector<STrackedObject>> Hyprutils::Memory::Tracker::findCycles() {
+    auto objects = liveObjects();
+
+    std::ranges::sort(objects, std::less<>{}, [](const auto& o) { return o.data; });
+
+    std::unordered_map<const void*, size_t> indexOf;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        indexOf[objects[i].block] = i;
+    }
+
+    // strong edges between tracked objects, found by looking for shared pointers living inside of them
+    std::vector<std::vector<size_t>> edges(objects.size());
+    std::vector<uint32_t>            internalRefs(objects.size(), 0);
+
+    for (auto& shard : g_instanceShards) {
+        std::lock_guard<std::mutex> lg(shard.mutex);
+
+        for (const auto* instance : shard.instances) {
+            const auto TARGET = indexOf.find(*instance);
+            if (TARGET == indexOf.end())
+                continue;
+
+            // the last object starting at or before the instance
+            auto owner = std::ranges::upper_bound(objects, sc<const void*>(instance), std::less<>{}, [](const auto& o) { return o.data; });
+            if (owner == objects.begin())
+                continue;
+
+            --owner;
+            const auto* BEGIN = sc<const unsigned char*>(owner->data);
+            if (rc<const unsigned char*>(instance) >= BEGIN + owner->size)
+                continue;
+
+            edges[owner - objects.begin()].emplace_back(TARGET->second);
+            internalRefs[TARGET->second]++;
+        }
+    }
+
+    // whatever holds more strong refs than other objects account for is referenced from outside: a root
+    std::vector<bool>   reachable(objects.size(), false);
+    std::vector<size_t> stack;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (objects[i].strong > internalRefs[i]) {
+            reachable[i] = true;
+            stack.emplace_back(i);
+        }
+    }
+
+    while (!stack.empty()) {
+        const auto CURRENT = stack.back();
+        stack.pop_back();
+
+        for (const auto next : edges[CURRENT]) {
+            if (reachable[next])
+                continue;
+
+            reachable[next] = true;
+            stack.emplace_back(next);
+        }
+    }
+
+    // Tarjan's SCC over what is left. Iterative, a long chain of objects would overflow the stack otherwise
+    std::vector<std::vector<STrackedObject>> cycles;
+    std::vector<int64_t>                     index(objects.size(), -1), lowlink(objects.size(), 0);
+    std::vector<bool>                        onStack(objects.size(), false);
+    std::vector<size_t>                      sccStack;
+    int64_t                                  counter = 0;
+
+    // a vertex being visited, and how far through its edges it got
+    struct SFrame {
+        size_t v    = 0;
+        size_t edge = 0;
+    };
+    std::vector<SFrame> callStack;
+
+    const auto          visit = [&](size_t v) {
+        index[v] = lowlink[v] = counter++;
+        sccStack.emplace_back(v);
+        onStack[v] = true;
+        callStack.emplace_back(SFrame{.v = v});
+    };
+
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (reachable[i] || index[i] != -1)
+            continue;
+
+        visit(i);
+
+        while (!callStack.empty()) {
+            auto&        frame = callStack.back();
+            const size_t V     = frame.v;
+
+            if (frame.edge < edges[V].size()) {
+                const auto W = edges[V][frame.edge++];
+                if (reachable[W])
+                    continue;
+
+                // frame is invalidated from here on
+                if (index[W] == -1)
+                    visit(W);
+                else if (onStack[W])
+                    lowlink[V] = std::min(lowlink[V], index[W]);
+
+                continue;
+            }
+
+            // done with V, hand its lowlink back to the caller
+            callStack.pop_back();
+            if (!callStack.empty())
+                lowlink[callStack.back().v] = std::min(lowlink[callStack.back().v], lowlink[V]);
+
+            if (lowlink[V] != index[V])
+                continue;
+
+            std::vector<STrackedObject> component;
+            size_t                      w = 0;
+            do {
+                w = sccStack.back();
+                sccStack.pop_back();
+                onStack[w] = false;
+                component.emplace_back(objects[w]);
+            } while (w != V);
+
+            const bool SELFLOOP = std::ranges::find(edges[V], V) != edges[V].end();
+            if (component.size() > 1 || SELFLOOP)
+                cycles.emplace_back(std::move(component));
+        }
+    }
+
+    return cycles;
+}
+
+static std::string describe(const STrackedObject& o) {
+    std::string result = std::format("  {} @ {} (strong {}, weak {})\n", o.type, o.data, o.strong, o.weak);
+
+#ifdef HAS_BACKTRACE
+    if (o.site.empty())
+        return result;
+
+    char** symbols = backtrace_symbols(o.site.data(), o.site.size());
+    if (!symbols)
+        return result;
+
+    for (size_t i = 0; i < o.site.size(); ++i) {
+        result += std::format("    #{} {}\n", i, symbols[i]);
+    }
+
+    std::free(symbols);
+#endif
+
+    return result;
+}
+
+std::string Hyprutils::Memory::Tracker::dump() {
+    const auto  OBJECTS = liveObjects();
+    const auto  CYCLES  = findCycles();
+
+    std::string result = std::format("{} live tracked objects\n", OBJECTS.size());
+    for (const auto& o : OBJECTS) {
+        result += describe(o);
+    }
+
+    result += std::format("{} strong cycles\n", CYCLES.size());
+    for (size_t i = 0; i < CYCLES.size(); ++i) {
+        result += std::format(" cycle {}:\n", i);
+        for (const auto& o : CYCLES[i]) {
+            result += describe(o);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,36 @@
+#include <hyprutils/signal/CrossThreadSignal.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace Hyprutils::Signal;
+using namespace Hyprutils::OS;
+
+Hyprutils::Signal::Impl_::CWakeup::CWakeup() : m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    if (!m_fd.isValid())
+        throw std::runtime_error("CCrossThreadSignalT: failed to create an eventfd");
+}
+
+void Hyprutils::Signal::Impl_::CWakeup::notify() {
+    // one write until the owner gets to it is enough
+    if (m_notified.exchange(true))
+        return;
+
+    const uint64_t ONE = 1;
+    (void)!write(m_fd.get(), &ONE, sizeof(ONE));
+}
+
+void Hyprutils::Signal::Impl_::CWakeup::clear() {
+    // drain the fd first: a notify landing in between is then either read here, or writes again
+    uint64_t count = 0;
+    (void)!read(m_fd.get(), &count, sizeof(count));
+
+    // before draining the ring: whatever gets queued after this notifies again
+    m_notified.store(false);
+}
+
+const CFileDescriptor& Hyprutils::Signal::Impl_::CWakeup::fd() const {
+    return m_fd;
+}
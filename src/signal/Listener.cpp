@@ -3,15 +3,15 @@
 
 using namespace Hyprutils::Signal;
 
-Hyprutils::Signal::CSignalListener::CSignalListener(std::function<void(void*)> handler) : m_fHandler(handler) {
+Hyprutils::Signal::CSignalListener::CSignalListener(EmitFn emit) : m_fEmit(emit) {
     ;
 }
 
-void Hyprutils::Signal::CSignalListener::emitInternal(void* data) {
-    if (!m_fHandler)
-        return;
+bool Hyprutils::Signal::CSignalListener::emitInternal(void* data) {
+    if (!m_fEmit)
+        return false;
 
-    m_fHandler(data);
+    return m_fEmit(this, data);
 }
 
 void Hyprutils::Signal::CSignalListener::emit(std::any data) {
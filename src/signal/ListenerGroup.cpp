@@ -0,0 +1,32 @@
+#include <hyprutils/signal/ListenerGroup.hpp>
+#include <algorithm>
+
+using namespace Hyprutils::Signal;
+using namespace Hyprutils::Memory;
+
+Hyprutils::Signal::Impl_::CListenerArena::~CListenerArena() {
+    // newest first, like members of an object
+    for (SNode* node = m_pLast; node; node = node->prev) {
+        node->destroy(node->listener);
+    }
+}
+
+void* Hyprutils::Signal::Impl_::CListenerArena::allocate(size_t size, size_t align) {
+    void*  p     = m_pCursor;
+    size_t space = m_pEnd - m_pCursor;
+
+    if (!std::align(align, size, p, space)) {
+        // the slack covers any alignment
+        m_iNextChunk = std::max(m_iNextChunk * 2, size + align);
+
+        auto& chunk = m_vChunks.emplace_back(new std::byte[m_iNextChunk]);
+        p           = chunk.get();
+        space       = m_iNextChunk;
+        m_pEnd      = chunk.get() + m_iNextChunk;
+
+        std::align(align, size, p, space);
+    }
+
+    m_pCursor = sc<std::byte*>(p) + size;
+    return p;
+}
@@ -1,5 +1,6 @@
 #include "hyprutils/memory/SharedPtr.hpp"
 #include <hyprutils/signal/Signal.hpp>
+#include <hyprutils/signal/ListenerGroup.hpp>
 #include <hyprutils/memory/WeakPtr.hpp>
 #include <algorithm>
 
@@ -9,59 +10,243 @@ using namespace Hyprutils::Memory;
 #define SP CSharedPointer
 #define WP CWeakPointer
 
-void Hyprutils::Signal::CSignalBase::emitInternal(void* args) {
+/*
+    Emitting doesn't copy the listener lists. Instead, while an emit runs:
+     - listeners are only appended, never erased, so indices stay put. Those added during it are past its snapshot of the sizes.
+     - should the signal die, its destructor hands the lists over to the running emit,
+       which carries on with them, and passes them on to the emit it's nested in, if any.
+*/
+struct Hyprutils::Signal::CSignalBase::SEmitFrame {
+    // nullptr once the signal is gone
+    CSignalBase*                      signal = nullptr;
+    SEmitFrame*                       prev   = nullptr;
+
+    std::vector<WP<CSignalListener>>  listeners;
+    std::vector<SP<CSignalListener>>  staticListeners;
+
+    std::vector<WP<CSignalListener>>& currentListeners() {
+        return signal ? signal->m_vListeners : listeners;
+    }
 
-    // Save, an event can destroy thisptr
-    const auto STATICS = m_vStaticListeners;
+    std::vector<SP<CSignalListener>>& currentStaticListeners() {
+        return signal ? signal->m_vStaticListeners : staticListeners;
+    }
+};
 
-    if (!m_vListeners.empty()) {
-        std::vector<SP<CSignalListener>> listeners;
-        listeners.reserve(m_vListeners.size());
+Hyprutils::Signal::CSignalBase::~CSignalBase() {
+    if (!m_pEmitFrame)
+        return;
 
-        for (const auto& l : m_vListeners) {
-            if (l.expired())
-                continue;
+    m_pEmitFrame->signal          = nullptr;
+    m_pEmitFrame->listeners       = std::move(m_vListeners);
+    m_pEmitFrame->staticListeners = std::move(m_vStaticListeners);
+}
 
-            listeners.emplace_back(l.lock());
-        }
+Hyprutils::Signal::CSignalBase::CSignalBase(const CSignalBase& other) : m_vListeners(other.m_vListeners), m_vStaticListeners(other.m_vStaticListeners) {
+#ifdef HYPRUTILS_SIGNAL_STATS
+    m_pStats = other.m_pStats;
+#endif
+}
+
+Hyprutils::Signal::CSignalBase::CSignalBase(CSignalBase&& other) noexcept : m_vListeners(std::move(other.m_vListeners)), m_vStaticListeners(std::move(other.m_vStaticListeners)) {
+#ifdef HYPRUTILS_SIGNAL_STATS
+    m_pStats = other.m_pStats;
+#endif
+}
+
+// a running emit keeps its frame, it's bounds-checked against the new lists. The name stays, it's ours
+
+CSignalBase& Hyprutils::Signal::CSignalBase::operator=(const CSignalBase& other) {
+    m_vListeners       = other.m_vListeners;
+    m_vStaticListeners = other.m_vStaticListeners;
+    return *this;
+}
 
-        for (const auto& l : listeners) {
-            // if there is only one lock, it means the event is only held by the listeners
-            // vector and was removed during our iteration
-            if (l.strongRef() == 1)
-                continue;
+CSignalBase& Hyprutils::Signal::CSignalBase::operator=(CSignalBase&& other) noexcept {
+    m_vListeners       = std::move(other.m_vListeners);
+    m_vStaticListeners = std::move(other.m_vStaticListeners);
+    return *this;
+}
+
+void Hyprutils::Signal::CSignalBase::setName(const std::string& name) {
+#ifdef HYPRUTILS_SIGNAL_STATS
+    m_pStats = name.empty() ? nullptr : Impl_::statsRecord(name);
+#endif
+}
 
-            l->emitInternal(args);
+void Hyprutils::Signal::CSignalBase::disconnect(const CListenerGroup& group) {
+    const auto* IMPL = group.m_arena.impl_;
+    if (!IMPL)
+        return;
+
+    // while emitting, the indices must stay put. Emptied, and swept like any stale entry
+    if (m_pEmitFrame) {
+        for (auto& listener : m_vListeners) {
+            if (listener.impl_ == IMPL)
+                listener.reset();
         }
 
-        // release SPs
-        listeners.clear();
+        return;
     }
 
-    if (!STATICS.empty()) {
-        for (const auto& l : STATICS) {
-            l->emitInternal(args);
+    std::erase_if(m_vListeners, [IMPL](const auto& other) { return other.impl_ == IMPL; });
+}
+
+bool Hyprutils::Signal::CSignalBase::emitInternal(void* args, bool consumable) {
+#ifdef HYPRUTILS_SIGNAL_STATS
+    // the record outlives us, it's fine to use should we die during the emit
+    auto* const STATS = m_pStats;
+    const auto  START = STATS ? Impl_::beginEmit(STATS) : 0;
+#endif
+
+    SEmitFrame frame{.signal = this, .prev = m_pEmitFrame};
+    m_pEmitFrame = &frame;
+
+    // listeners added during the emit are not invoked
+    const size_t LISTENERS = m_vListeners.size();
+    const size_t STATICS   = m_vStaticListeners.size();
+
+    size_t       stale    = 0;
+    bool         consumed = false;
+
+    // ends the frame however we leave, a throwing handler must not leave the signal pointing at it
+    struct SFrameGuard {
+        SEmitFrame&   frame;
+        const size_t& stale;
+
+        ~SFrameGuard() {
+            if (frame.signal) {
+                auto* const SIGNAL   = frame.signal;
+                SIGNAL->m_pEmitFrame = frame.prev;
+
+                if (!SIGNAL->m_pEmitFrame) {
+                    // listeners registered during the emit were appended, put them in place
+                    if (SIGNAL->m_bUnsorted)
+                        SIGNAL->sortListeners();
+                    // mostly stale, and we had to walk past them anyways
+                    else if (stale * 2 > SIGNAL->m_vListeners.size())
+                        SIGNAL->sweepListeners();
+                }
+            } else if (frame.prev) {
+                // we died during the emit, and the emit we are nested in needs the lists
+                frame.prev->signal          = nullptr;
+                frame.prev->listeners       = std::move(frame.listeners);
+                frame.prev->staticListeners = std::move(frame.staticListeners);
+            }
+        }
+    };
+
+    {
+        SFrameGuard guard{.frame = frame, .stale = stale};
+
+        // both lists are sorted by priority, merge them. On a tie, the regular listener goes first
+        for (size_t i = 0, j = 0; !consumed;) {
+            auto& listeners       = frame.currentListeners();
+            auto& staticListeners = frame.currentStaticListeners();
+
+            while (i < LISTENERS && i < listeners.size() && listeners[i].expired()) {
+                stale++;
+                i++;
+            }
+
+            const bool HASLISTENER = i < LISTENERS && i < listeners.size();
+            const bool HASSTATIC   = j < STATICS && j < staticListeners.size();
+
+            if (!HASLISTENER && !HASSTATIC)
+                break;
+
+            if (HASLISTENER && (!HASSTATIC || listeners[i]->m_iPriority >= staticListeners[j]->m_iPriority)) {
+                // hold it, the listener may be dropped by its own handler
+                const auto L = listeners[i++].lock();
+                consumed     = L->emitInternal(args) && consumable;
+            } else {
+                // the list outlives the emit, but could be assigned over
+                const auto L = staticListeners[j++];
+                consumed     = L->emitInternal(args) && consumable;
+            }
         }
     }
 
-    // we cannot release any expired refs here as one of the listeners could've removed this object and
-    // as such we'd be doing a UAF
+#ifdef HYPRUTILS_SIGNAL_STATS
+    // if consumed, whatever came after was not looked at, and counts as alive
+    if (STATS)
+        Impl_::endEmit(STATS, START, LISTENERS + STATICS - stale);
+#endif
+
+    return consumed;
 }
 
-CHyprSignalListener Hyprutils::Signal::CSignalBase::registerListenerInternal(std::function<void(void*)> handler) {
-    CHyprSignalListener listener = SP<CSignalListener>(new CSignalListener(handler));
-    m_vListeners.emplace_back(listener);
+CHyprSignalListener Hyprutils::Signal::CSignalBase::registerListenerInternal(CHyprSignalListener listener, int priority) {
+    listener->m_iPriority = priority;
+
+    // while emitting, the indices must stay put. Appended, and sorted once the emit is done
+    if (m_pEmitFrame) {
+        if (!m_vListeners.empty() && (m_vListeners.back().expired() || m_vListeners.back()->m_iPriority < priority))
+            m_bUnsorted = true;
+
+        m_vListeners.emplace_back(listener);
+        return listener;
+    }
+
+    // listeners dropped right after listening pile up at the back, and we would walk past all of them every time.
+    // Each entry is popped once at most, so this stays amortized O(1)
+    while (!m_vListeners.empty() && m_vListeners.back().expired()) {
+        m_vListeners.pop_back();
+    }
+
+    // stale entries have no priority, but they are never invoked either, so they can be skipped.
+    // Walking back, everything alive we pass has a lower priority
+    auto it = m_vListeners.end();
+    while (it != m_vListeners.begin()) {
+        const auto& PREV = *(it - 1);
+        if (!PREV.expired() && PREV->m_iPriority >= priority)
+            break;
+
+        --it;
+    }
+
+    m_vListeners.insert(it, listener);
 
     // housekeeping: remove any stale listeners
-    std::erase_if(m_vListeners, [](const auto& other) { return other.expired(); });
+    if (m_vListeners.size() >= m_iNextSweep)
+        sweepListeners();
 
     return listener;
 }
 
-void Hyprutils::Signal::CSignalBase::registerStaticListenerInternal(std::function<void(void*)> handler) {
-    m_vStaticListeners.emplace_back(SP<CSignalListener>(new CSignalListener(handler)));
+void Hyprutils::Signal::CSignalBase::registerStaticListenerInternal(CHyprSignalListener listener, int priority) {
+    listener->m_iPriority = priority;
+
+    if (m_pEmitFrame) {
+        if (!m_vStaticListeners.empty() && m_vStaticListeners.back()->m_iPriority < priority)
+            m_bUnsorted = true;
+
+        m_vStaticListeners.emplace_back(std::move(listener));
+        return;
+    }
+
+    const auto IT = std::upper_bound(m_vStaticListeners.begin(), m_vStaticListeners.end(), priority, [](int p, const auto& other) { return p > other->m_iPriority; });
+    m_vStaticListeners.insert(IT, std::move(listener));
+}
+
+void Hyprutils::Signal::CSignalBase::sortListeners() {
+    // stale entries can't be sorted, they are gone after this
+    sweepListeners();
+
+    constexpr auto BYPRIORITY = [](const auto& a, const auto& b) { return a->m_iPriority > b->m_iPriority; };
+    std::ranges::stable_sort(m_vListeners, BYPRIORITY);
+    std::ranges::stable_sort(m_vStaticListeners, BYPRIORITY);
+    m_bUnsorted = false;
+}
+
+void Hyprutils::Signal::CSignalBase::sweepListeners() {
+    std::erase_if(m_vListeners, [](const auto& other) { return other.expired(); });
+
+    // only sweep again once the list doubled, that keeps registering amortized O(1)
+    m_iNextSweep = std::max<size_t>(m_vListeners.size() * 2, 16);
 }
 
+
 void Hyprutils::Signal::CSignal::emit(std::any data) {
     CSignalT::emit(data);
 }
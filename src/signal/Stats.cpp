@@ -0,0 +1,115 @@
+#include <hyprutils/signal/Stats.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using namespace Hyprutils::Signal;
+
+/*
+    Signals sharing a name can live on different threads, so the record is all relaxed atomics.
+    Uncontended, that's about as cheap as plain increments.
+*/
+struct Hyprutils::Signal::Impl_::SStatsRecord {
+    std::atomic<uint64_t> emits         = 0;
+    std::atomic<uint64_t> timedEmits    = 0;
+    std::atomic<size_t>   listeners     = 0;
+    std::atomic<uint64_t> totalDispatch = 0;
+    std::atomic<uint64_t> maxDispatch   = 0;
+};
+
+static std::mutex                                                            g_recordsMutex;
+static std::unordered_map<std::string, std::unique_ptr<Impl_::SStatsRecord>> g_records;
+static std::atomic<uint32_t>                                                 g_sampleRate    = 1;
+static thread_local uint32_t                                                 t_sampleCounter = 0;
+
+static uint64_t                                                              nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool Hyprutils::Signal::Stats::compiledIn() {
+#ifdef HYPRUTILS_SIGNAL_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Hyprutils::Signal::Stats::setSampleRate(uint32_t rate) {
+    g_sampleRate.store(rate, std::memory_order_relaxed);
+}
+
+std::vector<SSignalStats> Hyprutils::Signal::Stats::snapshot() {
+    std::vector<SSignalStats> result;
+
+    {
+        std::lock_guard<std::mutex> lg(g_recordsMutex);
+        result.reserve(g_records.size());
+
+        for (const auto& [name, record] : g_records) {
+            result.emplace_back(SSignalStats{
+                .name          = name,
+                .emits         = record->emits.load(std::memory_order_relaxed),
+                .timedEmits    = record->timedEmits.load(std::memory_order_relaxed),
+                .listeners     = record->listeners.load(std::memory_order_relaxed),
+                .totalDispatch = std::chrono::nanoseconds(record->totalDispatch.load(std::memory_order_relaxed)),
+                .maxDispatch   = std::chrono::nanoseconds(record->maxDispatch.load(std::memory_order_relaxed)),
+            });
+        }
+    }
+
+    std::ranges::sort(result, std::greater<>{}, [](const auto& s) { return s.totalDispatch; });
+    return result;
+}
+
+void Hyprutils::Signal::Stats::reset() {
+    std::lock_guard<std::mutex> lg(g_recordsMutex);
+
+    for (const auto& [name, record] : g_records) {
+        record->emits.store(0, std::memory_order_relaxed);
+        record->timedEmits.store(0, std::memory_order_relaxed);
+        record->listeners.store(0, std::memory_order_relaxed);
+        record->totalDispatch.store(0, std::memory_order_relaxed);
+        record->maxDispatch.store(0, std::memory_order_relaxed);
+    }
+}
+
+Impl_::SStatsRecord* Hyprutils::Signal::Impl_::statsRecord(const std::string& name) {
+    std::lock_guard<std::mutex> lg(g_recordsMutex);
+
+    auto& record = g_records[name];
+    if (!record)
+        record = std::make_unique<SStatsRecord>();
+
+    return record.get();
+}
+
+uint64_t Hyprutils::Signal::Impl_::beginEmit(SStatsRecord* record) noexcept {
+    record->emits.fetch_add(1, std::memory_order_relaxed);
+
+    const auto RATE = g_sampleRate.load(std::memory_order_relaxed);
+    if (RATE == 0 || ++t_sampleCounter % RATE != 0)
+        return 0;
+
+    return nowNs();
+}
+
+void Hyprutils::Signal::Impl_::endEmit(SStatsRecord* record, uint64_t start, size_t listeners) noexcept {
+    record->listeners.store(listeners, std::memory_order_relaxed);
+
+    if (start == 0)
+        return;
+
+    const uint64_t ELAPSED = nowNs() - start;
+
+    record->timedEmits.fetch_add(1, std::memory_order_relaxed);
+    record->totalDispatch.fetch_add(ELAPSED, std::memory_order_relaxed);
+
+    uint64_t max = record->maxDispatch.load(std::memory_order_relaxed);
+    while (ELAPSED > max && !record->maxDispatch.compare_exchange_weak(max, ELAPSED, std::memory_order_relaxed)) {
+        ;
+    }
+}
@@ -8,7 +8,10 @@
 #include <hyprutils/memory/UniquePtr.hpp>
 #include <hyprutils/animation/Spring.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <ranges>
+#include <thread>
 
 #define SP CSharedPointer
 #define WP CWeakPointer
@@ -463,3 +466,200 @@ TEST(Animation, springDoesNotAdvanceFasterThanElapsedTime) {
     EXPECT_NEAR(repeatedValue, singleValue, 0.0001F);
     EXPECT_LT(repeatedValue, 0.5F);
 }
+
+TEST(Animation, manyActiveVariables) {
+    CMyAnimationManager        manager;
+    std::vector<PANIMVAR<int>> vars(2000);
+
+    int                        connected    = 0;
+    int                        disconnected = 0;
+
+    auto                       onConnect    = manager.getSignals()->connect.listen([&connected] { connected++; });
+    auto                       onDisconnect = manager.getSignals()->disconnect.listen([&disconnected] { disconnected++; });
+
+    // a config of our own, the tree may not be set up
+    const auto CONFIG = makeShared<SAnimationPropertyConfig>();
+    for (auto& var : vars) {
+        var = makeUnique<CAnimatedVariable<int>>();
+        var->create2(eAVTypes::INT, &manager, var, 0);
+        var->setConfig(CONFIG);
+        *var = 10;
+    }
+
+    EXPECT_EQ(manager.m_vActiveAnimatedVariables.size(), 2000);
+    EXPECT_EQ(connected, 2000);
+
+    // every third dies, every third is warped, from both ends so entries get moved around
+    for (size_t i = 0; i < vars.size() / 2; ++i) {
+        for (const size_t IDX : {i, vars.size() - 1 - i}) {
+            if (IDX % 3 == 0)
+                vars[IDX].reset();
+            else if (IDX % 3 == 1)
+                vars[IDX]->warp();
+        }
+    }
+
+    EXPECT_EQ(disconnected, 1334);
+    EXPECT_EQ(manager.m_vActiveAnimatedVariables.size(), 666);
+
+    for (size_t i = 0; i < vars.size(); ++i) {
+        const bool ACTIVE = std::ranges::any_of(manager.m_vActiveAnimatedVariables, [&](const auto& av) { return vars[i] && av.get() == vars[i].get(); });
+        EXPECT_EQ(ACTIVE, i % 3 == 2);
+    }
+
+    // rotating keeps the indices right
+    manager.tickDone();
+    for (auto& var : vars | std::views::reverse) {
+        var.reset();
+    }
+
+    EXPECT_TRUE(manager.m_vActiveAnimatedVariables.empty());
+    EXPECT_EQ(disconnected, 2000);
+}
+
+TEST(Animation, updateActive) {
+    CMyAnimationManager  manager;
+    CAnimationConfigTree tree;
+    tree.createNode("global");
+    tree.createNode("fast", "global");
+    tree.createNode("springy", "global");
+    tree.setConfigForNode("global", 1, 1.F, "default");
+    tree.setConfigForNode("fast", 1, 0.5F, "linear");
+    tree.setConfigForNode("springy", 1, 1.F, "spring:default");
+
+    manager.addBezierWithName("linear", {0.F, 0.F}, {1.F, 1.F});
+
+    std::vector<UP<CAnimatedVariable<float>>>    floats(100);
+    std::vector<UP<CAnimatedVariable<Vector2D>>> vectors(100);
+    PANIMVAR<SomeTestType>                       other;
+
+    int                                          updates = 0;
+    int                                          ends    = 0;
+
+    for (size_t i = 0; i < floats.size(); ++i) {
+        floats[i] = makeUnique<CAnimatedVariable<float>>();
+        floats[i]->create2(eAVTypes::INT, &manager, floats[i], 0.F);
+        floats[i]->setConfig(tree.getConfig(i % 3 == 0 ? "fast" : (i % 3 == 1 ? "springy" : "global")));
+        floats[i]->setUpdateCallback([&updates](auto) { updates++; });
+        *floats[i] = 10.F;
+        floats[i]->setCallbackOnEnd([&ends](auto) { ends++; });
+
+        vectors[i] = makeUnique<CAnimatedVariable<Vector2D>>();
+        vectors[i]->create2(eAVTypes::INT, &manager, vectors[i], Vector2D{});
+        vectors[i]->setConfig(tree.getConfig("fast"));
+        *vectors[i] = Vector2D{10, 20};
+        vectors[i]->setCallbackOnEnd([&ends](auto) { ends++; });
+    }
+
+    other = makeUnique<CAnimatedVariable<SomeTestType>>();
+    other->create2(eAVTypes::TEST, &manager, other, SomeTestType{});
+    other->setConfig(tree.getConfig("global"));
+    *other = SomeTestType{.done = true};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    manager.updateActive();
+    manager.tickDone();
+
+    EXPECT_GT(updates, 0);
+    for (const auto& v : floats) {
+        EXPECT_TRUE(v->isBeingAnimated());
+        EXPECT_GT(v->value(), 0.F);
+        EXPECT_LT(v->value(), 10.F);
+    }
+
+    // the batch leaves types update() can't handle alone
+    EXPECT_TRUE(other->isBeingAnimated());
+    EXPECT_FALSE(other->value().done);
+    other->warp();
+
+    while (manager.shouldTickForNext()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        manager.updateActive();
+        manager.tickDone();
+    }
+
+    EXPECT_EQ(ends, 200);
+    for (size_t i = 0; i < floats.size(); ++i) {
+        EXPECT_EQ(floats[i]->value(), 10.F);
+        EXPECT_EQ(vectors[i]->value(), (Vector2D{10, 20}));
+    }
+}
+
+TEST(Animation, updateActiveWarps) {
+    CMyAnimationManager manager;
+
+    auto                config = makeShared<SAnimationPropertyConfig>();
+    config->pValues            = config;
+    config->internalEnabled    = 1;
+    config->internalSpeed      = 100.F;
+    config->internalBezier     = "spring:default";
+
+    int             ends = 0;
+
+    PANIMVAR<float> spring = makeUnique<CAnimatedVariable<float>>();
+    spring->create2(eAVTypes::INT, &manager, spring, 0.F);
+    spring->setConfig(config);
+    *spring = 10.F;
+    spring->setCallbackOnEnd([&ends](auto) { ends++; });
+
+    // like update(), one without a config warps
+    auto lost              = makeShared<SAnimationPropertyConfig>();
+    lost->pValues          = lost;
+    lost->internalEnabled  = 1;
+    lost->internalSpeed    = 100.F;
+    PANIMVAR<float> orphan = makeUnique<CAnimatedVariable<float>>();
+    orphan->create2(eAVTypes::INT, &manager, orphan, 0.F);
+    orphan->setConfig(lost);
+    *orphan = 10.F;
+    orphan->setCallbackOnEnd([&ends](auto) { ends++; });
+    lost.reset();
+
+    EXPECT_FALSE(orphan->ok());
+
+    // a disabled spring is not stepped, it warps
+    config->internalEnabled = 0;
+
+    manager.updateActive();
+    manager.tickDone();
+
+    EXPECT_EQ(ends, 2);
+    EXPECT_EQ(spring->value(), 10.F);
+    EXPECT_EQ(orphan->value(), 10.F);
+    EXPECT_FALSE(manager.shouldTickForNext());
+}
+
+TEST(Animation, curveChanges) {
+    CMyAnimationManager  manager;
+    CAnimationConfigTree tree;
+    tree.createNode("global");
+    tree.setConfigForNode("global", 1, 10.F, "swap");
+
+    // stays close to 0, then jumps to 1
+    manager.addBezierWithName("swap", {1.F, 0.F}, {1.F, 0.F});
+
+    PANIMVAR<float> var = makeUnique<CAnimatedVariable<float>>();
+    var->create2(eAVTypes::INT, &manager, var, 0.F);
+    var->setConfig(tree.getConfig("global"));
+    *var = 1.F;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_LT(var->getCurveValue(), 0.01F);
+
+    // the cached curve is dropped once the manager's curves change
+    manager.addBezierWithName("swap", {0.F, 1.F}, {0.F, 1.F});
+    EXPECT_GT(var->getCurveValue(), 0.5F);
+
+    // and when the config changes in place, on the next animation. Until then, the curve stays what it was
+    tree.setConfigForNode("global", 1, 10.F, "missing");
+    EXPECT_GT(var->getCurveValue(), 0.5F);
+
+    tree.setConfigForNode("global", 1, 10.F, "spring:default");
+    EXPECT_GT(var->getCurveValue(), 0.5F);
+    EXPECT_FALSE(var->getCurveStep().finished);
+
+    tree.setConfigForNode("global", 1, 10.F, "missing");
+
+    *var = 2.F;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_NEAR(var->getCurveValue(), manager.getBezier("default")->getYForPoint(var->getPercent()), 0.05F);
+}
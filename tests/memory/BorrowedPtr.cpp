@@ -0,0 +1,83 @@
+#include <hyprutils/memory/BorrowedPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <functional>
+
+using namespace Hyprutils::Memory;
+
+#define BP CBorrowedPointer
+
+namespace {
+    class CBase {
+      public:
+        virtual ~CBase() = default;
+        int value        = 1;
+    };
+
+    class CDerived : public CBase {
+      public:
+        int derivedValue = 2;
+    };
+}
+
+static_assert(std::is_trivially_copyable_v<BP<CBase>>);
+
+TEST(Memory, borrowed) {
+    auto                shared = makeShared<CDerived>();
+    CWeakPointer<CBase> weak   = shared;
+
+    const auto          REFS  = shared.strongRef();
+    const auto          WREFS = shared.impl_->wref();
+
+    {
+        BP<CBase> fromShared = shared;
+        BP<CBase> fromWeak   = weak;
+        BP<CBase> copy       = fromShared;
+
+        // none of these touch the counts
+        EXPECT_EQ(shared.strongRef(), REFS);
+        EXPECT_EQ(shared.impl_->wref(), WREFS);
+
+        EXPECT_EQ(fromShared->value, 1);
+        EXPECT_EQ(fromWeak, copy);
+        EXPECT_EQ(dynamicPointerCast<CDerived>(copy)->derivedValue, 2);
+
+        // a callee can still keep a ref
+        CWeakPointer<CBase> kept = copy;
+        EXPECT_EQ(shared.impl_->wref(), WREFS + 1);
+        EXPECT_EQ(copy.lock().get(), shared.get());
+    }
+
+    EXPECT_EQ(shared.strongRef(), REFS);
+    EXPECT_EQ(shared.impl_->wref(), WREFS);
+
+    // callbacks taking a weak ptr still accept borrowed args
+    int                            seen = 0;
+    std::function<void(BP<CBase>)> fn   = [&seen](CWeakPointer<CBase> p) { seen = p->value; };
+    fn(shared);
+    EXPECT_EQ(seen, 1);
+
+    auto    unique     = makeUnique<int>(5);
+    BP<int> fromUnique = unique;
+    EXPECT_EQ(*fromUnique, 5);
+
+    BP<int> empty = CSharedPointer<int>{};
+    EXPECT_FALSE(empty);
+    EXPECT_EQ(empty, nullptr);
+    EXPECT_FALSE(empty.lock());
+
+#ifdef HYPRLAND_DEBUG
+    // dangling: the object is gone, the weak ref keeps the block around
+    auto              dying     = makeShared<int>(1);
+    CWeakPointer<int> keepBlock = dying;
+    BP<int>           dangling  = dying;
+    dying.reset();
+    EXPECT_DEATH((void)*dangling, "outlived");
+
+    // the fused block is freed along with the object, and must not be read
+    auto    freed        = makeShared<int>(1);
+    BP<int> danglingFree = freed;
+    freed.reset();
+    EXPECT_DEATH((void)*danglingFree, "outlived");
+#endif
+}
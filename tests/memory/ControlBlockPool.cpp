@@ -0,0 +1,110 @@
+#include <hyprutils/memory/ControlBlockPool.hpp>
+#include <hyprutils/memory/Atomic.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/UniquePtr.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+TEST(Memory, controlBlockPool) {
+    ControlBlockPool::setThreadMode(POOL_MODE_ENABLED);
+    ControlBlockPool::trim();
+    ControlBlockPool::resetStats();
+
+    EXPECT_TRUE(ControlBlockPool::enabled());
+
+    const auto LIVEBEFORE = ControlBlockPool::stats().liveBlocks;
+
+    {
+        std::vector<CSharedPointer<int>> sps;
+        for (int i = 0; i < 100; ++i) {
+            sps.emplace_back(makeShared<int>(i));
+        }
+
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE + 100);
+        EXPECT_EQ(ControlBlockPool::stats().misses, 100);
+        EXPECT_EQ(ControlBlockPool::stats().hits, 0);
+    }
+
+    EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE);
+
+    {
+        // same size class, all of these should come from the free list
+        std::vector<CSharedPointer<int>> sps;
+        for (int i = 0; i < 100; ++i) {
+            sps.emplace_back(makeShared<int>(i));
+        }
+
+        EXPECT_EQ(ControlBlockPool::stats().hits, 100);
+        EXPECT_EQ(*sps[42], 42);
+    }
+
+    {
+        // a weak ref keeps the block alive past the object
+        auto              sp   = makeShared<int>(1);
+        CWeakPointer<int> weak = sp;
+        sp.reset();
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE + 1);
+        weak.reset();
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE);
+    }
+
+    {
+        auto up    = CUniquePointer<int>(new int(1));
+        auto sp    = CSharedPointer<int>(new int(2));
+        auto atomo = makeAtomicShared<int>(3);
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE + 3);
+    }
+
+    EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE);
+
+    {
+        // a block allocated here and released by a thread without the pool goes back to the allocator
+        auto        sp = makeShared<int>(1);
+        std::thread thread([sp = std::move(sp)]() mutable {
+            ControlBlockPool::setThreadMode(POOL_MODE_DISABLED);
+            sp.reset();
+        });
+        thread.join();
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE);
+    }
+
+    {
+        // each thread counts on its own, the stats add them up, even once a thread is gone
+        const auto                       MISSES = ControlBlockPool::stats().misses;
+        std::vector<CSharedPointer<int>> kept(4);
+        std::vector<std::thread>         threads;
+        for (size_t i = 0; i < kept.size(); ++i) {
+            threads.emplace_back([&kept, i]() {
+                ControlBlockPool::setThreadMode(POOL_MODE_ENABLED);
+                kept[i] = makeShared<int>(1);
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE + 4);
+        EXPECT_EQ(ControlBlockPool::stats().misses, MISSES + 4);
+
+        kept.clear();
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE);
+    }
+
+    ControlBlockPool::setThreadMode(POOL_MODE_DISABLED);
+    ControlBlockPool::resetStats();
+
+    {
+        auto sp = makeShared<int>(1);
+        EXPECT_EQ(ControlBlockPool::stats().misses, 0);
+        EXPECT_EQ(ControlBlockPool::stats().liveBlocks, LIVEBEFORE);
+    }
+
+    ControlBlockPool::trim();
+    ControlBlockPool::setThreadMode(POOL_MODE_INHERIT);
+}
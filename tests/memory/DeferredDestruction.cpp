@@ -0,0 +1,88 @@
+#include <hyprutils/memory/DeferredDestruction.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    class CNode {
+      public:
+        CNode(int* destroyed_) : destroyed(destroyed_) {
+            ;
+        }
+
+        ~CNode() {
+            (*destroyed)++;
+        }
+
+        int*                               destroyed = nullptr;
+        std::vector<CSharedPointer<CNode>> children;
+    };
+}
+
+TEST(Memory, deferredDestruction) {
+    int destroyed = 0;
+
+    DeferredDestruction::setEnabled(true);
+    EXPECT_TRUE(DeferredDestruction::enabled());
+
+    {
+        auto                root = makeShared<CNode>(&destroyed);
+        CWeakPointer<CNode> weak = root;
+        root->children.emplace_back(makeShared<CNode>(&destroyed));
+        root->children.emplace_back(makeShared<CNode>(&destroyed));
+
+        root.reset();
+
+        // nothing is gone yet, but the weak ref can't bring it back either
+        EXPECT_EQ(destroyed, 0);
+        EXPECT_EQ(DeferredDestruction::pending(), 1);
+        EXPECT_TRUE(weak.expired());
+        EXPECT_TRUE(weak.valid());
+        EXPECT_FALSE(weak.lock());
+
+        // the root's children are retired by its destructor, and only drained up to max
+        EXPECT_EQ(DeferredDestruction::drain(2), 2);
+        EXPECT_EQ(destroyed, 2);
+        EXPECT_EQ(DeferredDestruction::pending(), 1);
+        EXPECT_FALSE(weak.valid());
+
+        EXPECT_EQ(DeferredDestruction::drain(), 1);
+        EXPECT_EQ(destroyed, 3);
+        EXPECT_EQ(DeferredDestruction::pending(), 0);
+    }
+
+    {
+        // a weak ref dropped while retired must not free the block under the list
+        auto                node = makeShared<CNode>(&destroyed);
+        CWeakPointer<CNode> weak = node;
+        node.reset();
+        weak.reset();
+        EXPECT_EQ(DeferredDestruction::drain(), 1);
+        EXPECT_EQ(destroyed, 4);
+    }
+
+    DeferredDestruction::setEnabled(false);
+
+    {
+        auto node = makeShared<CNode>(&destroyed);
+        node.reset();
+        EXPECT_EQ(destroyed, 5);
+        EXPECT_EQ(DeferredDestruction::pending(), 0);
+    }
+
+    {
+        // leftovers go when the thread does
+        std::thread thread([&destroyed]() {
+            DeferredDestruction::setEnabled(true);
+            auto node = makeShared<CNode>(&destroyed);
+            node->children.emplace_back(makeShared<CNode>(&destroyed));
+        });
+        thread.join();
+        EXPECT_EQ(destroyed, 7);
+    }
+}
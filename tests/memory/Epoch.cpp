@@ -0,0 +1,121 @@
+#include <hyprutils/memory/Atomic.hpp>
+#include <hyprutils/memory/Epoch.hpp>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    struct SConfig {
+        SConfig(int value_, std::atomic<int>* destroyed_) : value(value_), destroyed(destroyed_) {
+            ;
+        }
+
+        ~SConfig() {
+            value = -1;
+            destroyed->fetch_add(1);
+        }
+
+        int               value     = 0;
+        std::atomic<int>* destroyed = nullptr;
+    };
+}
+
+TEST(Memory, epochPeek) {
+    std::atomic<int> destroyed = 0;
+
+    {
+        auto                        config = makeAtomicShared<SConfig>(1, &destroyed);
+        CAtomicWeakPointer<SConfig> weak   = config;
+
+        {
+            CEpochGuard guard;
+            EXPECT_EQ(weak.peek(guard)->value, 1);
+            // peeking does not take a ref
+            EXPECT_EQ(config.strongRef(), 1);
+        }
+
+        // no one is pinned, so this destroys right away
+        config.reset();
+        EXPECT_EQ(destroyed, 1);
+
+        CEpochGuard guard;
+        EXPECT_EQ(weak.peek(guard), nullptr);
+    }
+
+    {
+        auto                        config = makeAtomicShared<SConfig>(2, &destroyed);
+        CAtomicWeakPointer<SConfig> weak   = config;
+
+        std::atomic<bool>           pinned = false, dropped = false;
+        std::thread                 reader([&]() {
+            CEpochGuard guard;
+            auto*       data = weak.peek(guard);
+            pinned           = true;
+
+            while (!dropped) {
+                std::this_thread::yield();
+            }
+
+            // the last ref is gone, but we are still pinned
+            EXPECT_EQ(data->value, 2);
+            EXPECT_EQ(weak.peek(guard), nullptr);
+        });
+
+        while (!pinned) {
+            std::this_thread::yield();
+        }
+
+        config.reset();
+        EXPECT_EQ(destroyed, 1);
+        EXPECT_EQ(Epoch::pending(), 1);
+
+        dropped = true;
+        reader.join();
+
+        // the reader reclaimed it on its way out
+        EXPECT_EQ(destroyed, 2);
+        EXPECT_EQ(Epoch::pending(), 0);
+    }
+
+    {
+        // readers race the last ref being dropped, none of them may see freed data
+        constexpr int                            READERS = 4;
+        auto                                     config  = makeAtomicShared<SConfig>(3, &destroyed);
+        CAtomicWeakPointer<SConfig>              weak    = config;
+        std::atomic<bool>                        start   = false;
+        std::vector<std::thread>                 readers;
+        std::vector<CAtomicWeakPointer<SConfig>> weaks(READERS, weak);
+
+        for (int i = 0; i < READERS; ++i) {
+            readers.emplace_back([&, i]() {
+                while (!start) {
+                    std::this_thread::yield();
+                }
+
+                for (int j = 0; j < 10000; ++j) {
+                    CEpochGuard guard;
+                    auto*       data = weaks[i].peek(guard);
+                    if (!data)
+                        break;
+
+                    EXPECT_EQ(data->value, 3);
+                }
+            });
+        }
+
+        start = true;
+        config.reset();
+
+        for (auto& r : readers) {
+            r.join();
+        }
+
+        Epoch::collect();
+        EXPECT_EQ(destroyed, 3);
+        EXPECT_EQ(Epoch::pending(), 0);
+    }
+}
@@ -0,0 +1,140 @@
+#include <hyprutils/memory/Intrusive.hpp>
+
+#include <gtest/gtest.h>
+#include <unordered_set>
+
+using namespace Hyprutils::Memory;
+
+#define IP  CIntrusivePointer
+#define IWP CIntrusiveWeakPointer
+
+namespace {
+    class CSurface : public CIntrusiveRefCounted {
+      public:
+        IP<CSurface> self() {
+            return IP<CSurface>(this);
+        }
+
+        IWP<CSurface> weakSelf;
+        int           value = 1;
+    };
+
+    class CSubsurface : public CSurface {
+      public:
+        int subValue = 2;
+    };
+
+    class CUnrelated : public CIntrusiveRefCounted {};
+}
+
+template <typename A, typename B>
+concept EqualityComparable = requires(A a, B b) { a == b; };
+
+static_assert(sizeof(IP<CSurface>) == sizeof(void*));
+static_assert(sizeof(IWP<CSurface>) == sizeof(void*));
+static_assert(!EqualityComparable<IP<CSurface>, IP<CUnrelated>>);
+
+TEST(Memory, intrusive) {
+    IP<CSurface> surface = makeIntrusive<CSurface>();
+    EXPECT_EQ(surface.strongRef(), 1);
+
+    {
+        // re-adopting from a raw pointer shares the count
+        auto other = surface->self();
+        EXPECT_EQ(surface.strongRef(), 2);
+        EXPECT_EQ(other, surface);
+    }
+
+    EXPECT_EQ(surface.strongRef(), 1);
+
+    IWP<CSurface> weak = surface;
+    surface->weakSelf  = surface;
+    EXPECT_EQ(surface->intrusiveWeakRef(), 2);
+    EXPECT_TRUE(weak.lock());
+    EXPECT_FALSE(weak.expired());
+
+    surface.reset();
+
+    EXPECT_EQ(weak.get(), nullptr);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.valid());
+    EXPECT_FALSE(weak.lock());
+
+    IP<CSubsurface> sub     = makeIntrusive<CSubsurface>();
+    IP<CSurface>    subBase = sub;
+    EXPECT_EQ(sub.strongRef(), 2);
+    EXPECT_EQ(dynamicPointerCast<CSubsurface>(subBase)->subValue, 2);
+    EXPECT_EQ(dynamicPointerCast<CSubsurface>(IWP<CSurface>{subBase})->subValue, 2);
+
+    std::unordered_set<IP<CSurface>> set;
+    set.emplace(subBase);
+    EXPECT_TRUE(set.contains(subBase));
+}
+
+TEST(Memory, intrusiveDestruction) {
+    int  seen   = 0;
+    bool locked = true;
+
+    class CObserved : public CIntrusiveRefCounted {
+      public:
+        CObserved(int* seen_, bool* locked_) : seen(seen_), locked(locked_) {
+            ;
+        }
+
+        ~CObserved() override {
+            *seen   = self->value;
+            *locked = !!self.lock();
+        }
+
+        IWP<CObserved> self;
+        int            value = 42;
+        int*           seen;
+        bool*          locked;
+    };
+
+    auto           observed = makeIntrusive<CObserved>(&seen, &locked);
+    IWP<CObserved> weak     = observed;
+    observed->self          = observed;
+    observed.reset();
+
+    EXPECT_EQ(seen, 42);
+    EXPECT_FALSE(locked);
+    EXPECT_FALSE(weak);
+
+    // weak ref created during destruction must not be lockable either
+    class CLate : public CIntrusiveRefCounted {
+      public:
+        CLate(bool* locked_) : locked(locked_) {
+            ;
+        }
+
+        ~CLate() override {
+            *locked = !!IWP<CLate>(this).lock();
+        }
+
+        bool* locked;
+    };
+
+    locked = true;
+    makeIntrusive<CLate>(&locked).reset();
+    EXPECT_FALSE(locked);
+
+    // a strong ref made from this during destruction must not delete it again
+    class CSelfRef : public CIntrusiveRefCounted {
+      public:
+        CSelfRef(unsigned int* ref_) : ref(ref_) {
+            ;
+        }
+
+        ~CSelfRef() override {
+            IP<CSelfRef> self(this);
+            *ref = self.strongRef();
+        }
+
+        unsigned int* ref;
+    };
+
+    unsigned int ref = 1;
+    makeIntrusive<CSelfRef>(&ref).reset();
+    EXPECT_EQ(ref, 0);
+}
@@ -5,6 +5,7 @@
 
 #include <gtest/gtest.h>
 #include <chrono>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -33,6 +34,9 @@ static_assert(!EqualityComparable<UP<Peepee>, UP<Poopoo>>);
 static_assert(!EqualityComparable<ASP<Peepee>, ASP<Poopoo>>);
 static_assert(!EqualityComparable<AWP<Peepee>, AWP<Poopoo>>);
 
+static_assert(std::is_same_v<CSharedPointerFor<int>, SP<int>>);
+static_assert(std::is_same_v<CSharedPointerFor<int, Impl_::SAtomicCounts>, ASP<int>>);
+
 static void testAtomicImpl() {
     {
         // Using makeShared here could lead to invalid refcounts.
@@ -94,6 +98,48 @@ static void testAtomicImpl() {
         EXPECT_EQ(weak.expired(), true);
     }
 
+    {
+        // refcounts have to be exact after concurrent copies and upgrades
+        ASP<int>                 shared = makeAtomicShared<int>(0);
+        AWP<int>                 weak   = shared;
+        std::vector<std::thread> threads;
+
+        threads.reserve(NTHREADS);
+        for (size_t i = 0; i < NTHREADS; i++) {
+            threads.emplace_back([shared, weak]() {
+                std::vector<ASP<int>> copies;
+                copies.reserve(ITERATIONS / 10);
+                for (size_t j = 0; j < ITERATIONS; j++) {
+                    if (j % 10 == 0)
+                        copies.emplace_back(weak.lock());
+                    AWP<int> weakCopy = weak;
+                    ASP<int> copy     = shared;
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(shared.strongRef(), 1);
+        EXPECT_EQ(shared.impl()->wref(), 1); // not counting the one held on behalf of the strong refs
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+        {
+            // the compat mutex is still recursive
+            auto                                  lg = shared.impl()->lockGuard();
+            std::lock_guard<std::recursive_mutex> again(shared.impl()->getMutex());
+        }
+#pragma GCC diagnostic pop
+
+        shared.reset();
+        EXPECT_TRUE(weak.expired());
+        EXPECT_FALSE(weak.lock());
+        EXPECT_EQ(weak.impl()->wref(), 1);
+    }
+
     { // This tests recursive deletion. When foo will be deleted, bar will be deleted within the foo dtor.
         class CFoo {
           public:
@@ -468,6 +514,206 @@ static void testSelfDestruct() {
     weak->youShouldKysNOW();
 }
 
+class CInlineObserved {
+  public:
+    WP<CInlineObserved> self;
+    int                 value       = 42;
+    int*                seenOnDeath = nullptr;
+
+    ~CInlineObserved() {
+        // self is still derefable while we are being destroyed
+        *seenOnDeath = self->value;
+    }
+};
+
+static void testInlineStorage() {
+    int                 seen   = 0;
+    SP<CInlineObserved> shared = makeShared<CInlineObserved>();
+    const auto*         block  = rc<const unsigned char*>(shared.impl_);
+    const auto*         data   = rc<const unsigned char*>(shared.get());
+
+    shared->self        = shared;
+    shared->seenOnDeath = &seen;
+
+    // object lives right behind the control block
+    EXPECT_EQ(data - block, sc<std::ptrdiff_t>(Hyprutils::Memory::Impl_::inlineDataOffset<CInlineObserved>()));
+
+    WP<CInlineObserved> weak = shared;
+    shared.reset();
+
+    EXPECT_EQ(seen, 42);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.valid());
+    EXPECT_EQ(weak.impl_->wref(), 1);
+
+    // releasing the last weak ref frees the whole block. Asan will complain otherwise.
+    weak.reset();
+
+    struct alignas(64) SOverAligned {
+        int value = 7;
+    };
+
+    auto overAligned = makeShared<SOverAligned>();
+    EXPECT_EQ(rc<uintptr_t>(overAligned.get()) % 64, 0);
+    EXPECT_EQ(overAligned->value, 7);
+
+    struct SThrows {
+        SThrows() {
+            throw std::runtime_error("nope");
+        }
+    };
+
+    EXPECT_THROW((void)makeShared<SThrows>(), std::runtime_error);
+}
+
+static void testFootprint() {
+    using Hyprutils::Memory::Impl_::impl_base;
+    using Hyprutils::Memory::Impl_::inlineDataOffset;
+
+    // two counts, the data pointer, the deleter index, and the size class and thread in its padding
+    if constexpr (sizeof(void*) == 8) {
+        EXPECT_EQ(sizeof(impl_base), 24);
+        EXPECT_EQ(inlineDataOffset<int>() + sizeof(int), 28);
+    }
+
+    // flags in the top bits of the refcount must not leak into the counts
+    auto shared = makeShared<int>(1);
+    auto copy   = shared;
+    EXPECT_EQ(shared.strongRef(), 2);
+    EXPECT_TRUE(shared.impl_->lockable());
+    EXPECT_FALSE(shared.impl_->destroying());
+
+    auto unique = makeUnique<int>(1);
+    EXPECT_FALSE(unique.impl_->lockable());
+    EXPECT_EQ(unique.impl_->ref(), 1);
+
+    auto atomic = makeAtomicShared<int>(1);
+    auto atomo2 = atomic;
+    EXPECT_EQ(atomic.strongRef(), 2);
+}
+
+static void testAliasingAndArrays() {
+    struct SOwner {
+        int  value = 1;
+        int* destroyed;
+        ~SOwner() {
+            (*destroyed)++;
+        }
+    };
+
+    int destroyed = 0;
+
+    {
+        auto    owner = makeShared<SOwner>(1, &destroyed);
+        SP<int> alias(owner, &owner->value);
+        EXPECT_EQ(*alias, 1);
+        EXPECT_EQ(owner.strongRef(), 2);
+        EXPECT_EQ(alias.impl_, owner.impl_);
+
+        // the alias keeps the owner alive
+        WP<int> weakAlias = alias;
+        owner.reset();
+        EXPECT_EQ(destroyed, 0);
+        EXPECT_EQ(*weakAlias.lock(), 1);
+
+        SP<int> moved(std::move(alias), alias.get());
+        EXPECT_FALSE(alias);
+        moved.reset();
+        EXPECT_EQ(destroyed, 1);
+        EXPECT_FALSE(weakAlias.lock());
+    }
+
+    {
+        auto array = makeShared<int[]>(16);
+        for (int i = 0; i < 16; ++i) {
+            EXPECT_EQ(array[i], 0);
+            array[i] = i;
+        }
+
+        // one element, sharing the array's block
+        SP<int> element(array, &array[5]);
+        EXPECT_EQ(*element, 5);
+        EXPECT_EQ(array.strongRef(), 2);
+
+        WP<int[]> weak = array;
+        EXPECT_EQ(weak.lock()[15], 15);
+
+        SP<const int[]> constArray = array;
+        EXPECT_EQ(constArray[3], 3);
+
+        SP<int[]> fromNew(new int[4]{1, 2, 3, 4});
+        EXPECT_EQ(fromNew[3], 4);
+    }
+
+    {
+        struct SElement {
+            int* destroyed = nullptr;
+            ~SElement() {
+                if (destroyed)
+                    (*destroyed)++;
+            }
+        };
+
+        auto array = makeShared<SElement[]>(10);
+        for (int i = 0; i < 10; ++i) {
+            array[i].destroyed = &destroyed;
+        }
+
+        array.reset();
+        EXPECT_EQ(destroyed, 11);
+
+        // like new T[0], an empty array is still an allocation
+        EXPECT_TRUE(makeShared<SElement[]>(0));
+    }
+}
+
+static void testThreadAffinity() {
+    // the only ref may move to another thread
+    auto        handedOff = makeShared<int>(1);
+    std::thread thread([sp = std::move(handedOff)]() mutable {
+        auto copy = sp;
+        sp.reset();
+        EXPECT_EQ(*copy, 1);
+    });
+    thread.join();
+
+#ifdef HYPRLAND_DEBUG
+    // but a block counted from two threads at once traps
+    auto shared = makeShared<int>(1);
+    auto copy   = shared;
+    EXPECT_DEATH(std::thread([shared]() { auto another = shared; }).join(), "across threads");
+#endif
+
+    // atomic counts may be shared, of course
+    auto        atomic = makeAtomicShared<int>(1);
+    std::thread atomicThread([atomic]() { auto another = atomic; });
+    atomicThread.join();
+    EXPECT_EQ(atomic.strongRef(), 1);
+
+#ifdef HYPRLAND_DEBUG
+    // a plain block counted atomically would mix up both ways of counting
+    auto plain = makeShared<int>(1);
+    EXPECT_DEATH((void)ASP<int>(plain.impl_, plain.get()), "block of a CSharedPointer");
+    EXPECT_DEATH((void)AWP<int>(plain.impl_, plain.get()), "block of a CSharedPointer");
+#endif
+}
+
+template <typename C>
+static void testCountPolicy() {
+    static_assert(std::is_same_v<typename CSharedPointerFor<int, C>::Counts, C>);
+    static_assert(std::is_same_v<typename CWeakPointerFor<int, C>::Counts, C>);
+
+    CSharedPointerFor<int, C> shared = makeSharedFor<C, int>(5);
+    CWeakPointerFor<int, C>   weak   = shared;
+
+    EXPECT_EQ(*weak.lock(), 5);
+    EXPECT_EQ(shared.strongRef(), 1);
+
+    shared.reset();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.lock());
+}
+
 TEST(Memory, memory) {
     SP<int> intPtr    = makeShared<int>(10);
     SP<int> intPtr2   = makeShared<int>(-1337);
@@ -529,4 +775,11 @@ TEST(Memory, memory) {
     testConstPointers();
 
     testSelfDestruct();
+
+    testInlineStorage();
+    testFootprint();
+    testAliasingAndArrays();
+    testThreadAffinity();
+    testCountPolicy<Impl_::SPlainCounts>();
+    testCountPolicy<Impl_::SAtomicCounts>();
 }
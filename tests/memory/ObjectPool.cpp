@@ -0,0 +1,120 @@
+#include <hyprutils/memory/ObjectPool.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    class CPooled {
+      public:
+        CPooled(int value_, int* destroyed_) : value(value_), destroyed(destroyed_) {
+            ;
+        }
+
+        ~CPooled() {
+            (*destroyed)++;
+        }
+
+        int  value     = 0;
+        int* destroyed = nullptr;
+    };
+}
+
+TEST(Memory, objectPool) {
+    int destroyed = 0;
+
+    {
+        CObjectPool<CPooled>                 pool;
+        std::vector<CSharedPointer<CPooled>> objects;
+
+        for (int i = 0; i < 1000; ++i) {
+            objects.emplace_back(pool.makeShared(i, &destroyed));
+        }
+
+        EXPECT_EQ(pool.live(), 1000);
+        EXPECT_EQ(objects[42]->value, 42);
+
+        const auto SLABS = pool.slabs();
+        EXPECT_GT(SLABS, 0);
+
+        // slots are reused, the pool does not grow
+        std::set<void*> first;
+        for (auto& o : objects) {
+            first.emplace(o.get());
+        }
+
+        objects.clear();
+        EXPECT_EQ(destroyed, 1000);
+        EXPECT_EQ(pool.live(), 0);
+
+        for (int i = 0; i < 1000; ++i) {
+            objects.emplace_back(pool.makeShared(i, &destroyed));
+            EXPECT_TRUE(first.contains(objects.back().get()));
+        }
+
+        EXPECT_EQ(pool.slabs(), SLABS);
+
+        // a weak ref keeps the slot, but not the object
+        CWeakPointer<CPooled> weak = objects.back();
+        objects.pop_back();
+        EXPECT_EQ(destroyed, 1001);
+        EXPECT_EQ(pool.live(), 1000);
+        EXPECT_FALSE(weak.lock());
+        weak.reset();
+        EXPECT_EQ(pool.live(), 999);
+
+        auto unique = pool.makeUnique(7, &destroyed);
+        EXPECT_EQ(unique->value, 7);
+        EXPECT_FALSE(unique.impl_->lockable());
+
+    }
+
+    EXPECT_EQ(destroyed, 2001);
+
+    // the pool goes first, the object keeps its slab alive
+    {
+        CSharedPointer<CPooled> survivor;
+        {
+            CObjectPool<CPooled> pool;
+            survivor = pool.makeShared(1, &destroyed);
+        }
+
+        EXPECT_EQ(survivor->value, 1);
+    }
+
+    EXPECT_EQ(destroyed, 2002);
+
+    struct alignas(64) SAligned {
+        int value = 0;
+    };
+
+    CObjectPool<SAligned> aligned;
+    for (int i = 0; i < 100; ++i) {
+        auto p = aligned.makeShared(i);
+        EXPECT_EQ(rc<uintptr_t>(p.get()) % 64, 0);
+        EXPECT_EQ(p->value, i);
+    }
+
+    struct SThrows {
+        SThrows() {
+            throw std::runtime_error("nope");
+        }
+    };
+
+    CObjectPool<SThrows> throwing;
+    EXPECT_THROW((void)throwing.makeShared(), std::runtime_error);
+    EXPECT_EQ(throwing.live(), 0);
+
+#ifdef HYPRLAND_DEBUG
+    // a pool is single threaded, even a release from elsewhere traps
+    CObjectPool<int> local;
+    auto             first = local.makeShared(1);
+    EXPECT_DEATH(std::thread([&local]() { (void)local.makeShared(2); }).join(), "across threads");
+    EXPECT_DEATH(std::thread([sp = std::move(first)]() mutable { sp.reset(); }).join(), "across threads");
+#endif
+}
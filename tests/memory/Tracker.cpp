@@ -0,0 +1,142 @@
+#include <hyprutils/memory/Tracker.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    class CTreeNode {
+      public:
+        CSharedPointer<CTreeNode> child;
+        CWeakPointer<CTreeNode>   parent;
+        CWeakPointer<CTreeNode>   self;
+    };
+
+    class CBaseNode {
+      public:
+        virtual ~CBaseNode() = default;
+    };
+
+    class CDerivedNode : public CBaseNode {
+      public:
+        CSharedPointer<CBaseNode> next;
+    };
+}
+
+static bool contains(const std::vector<STrackedObject>& objects, const void* data) {
+    return std::ranges::any_of(objects, [data](const auto& o) { return o.data == data; });
+}
+
+TEST(Memory, tracker) {
+    if (!Tracker::compiledIn())
+        GTEST_SKIP() << "built without HYPRUTILS_TRACK_POINTERS";
+
+    Tracker::setSampleRate(1);
+
+    const auto CYCLESBEFORE = Tracker::findCycles().size();
+
+    // a proper tree, weak refs going up: no cycle
+    auto root           = makeShared<CTreeNode>();
+    root->self          = root;
+    root->child         = makeShared<CTreeNode>();
+    root->child->self   = root->child;
+    root->child->parent = root;
+
+    auto live = Tracker::liveObjects();
+    EXPECT_TRUE(contains(live, root.get()));
+    EXPECT_TRUE(contains(live, root->child.get()));
+    EXPECT_EQ(Tracker::findCycles().size(), CYCLESBEFORE);
+
+    // the child holds its parent strongly, and we drop our ref: leaked
+    auto* leakedRoot   = root.get();
+    auto* leakedChild  = root->child.get();
+    root->child->child = root;
+    root.reset();
+
+    const auto CYCLES = Tracker::findCycles();
+    ASSERT_EQ(CYCLES.size(), CYCLESBEFORE + 1);
+
+    const auto& CYCLE = *std::ranges::find_if(CYCLES, [&](const auto& c) { return contains(c, leakedRoot); });
+    EXPECT_EQ(CYCLE.size(), 2);
+    EXPECT_TRUE(contains(CYCLE, leakedChild));
+    EXPECT_NE(CYCLE.front().type.find("CTreeNode"), std::string::npos);
+
+    EXPECT_FALSE(Tracker::dump().empty());
+
+    // break it up, so asan stays quiet
+    leakedChild->child.reset();
+    EXPECT_EQ(Tracker::findCycles().size(), CYCLESBEFORE);
+
+    // pointers only register while they point into a sampled block, so one moved in later still counts
+    auto  first         = makeShared<CTreeNode>();
+    auto  second        = makeShared<CTreeNode>();
+    auto* leakedFirst   = first.get();
+    first->child        = std::move(second);
+    first->child->child = std::move(first);
+    ASSERT_EQ(Tracker::findCycles().size(), CYCLESBEFORE + 1);
+
+    // and one that is never sampled hides the cycle, rather than making one up
+    Tracker::setSampleRate(0);
+    auto unsampled = makeShared<CTreeNode>();
+    Tracker::setSampleRate(1);
+
+    auto  sampled       = makeShared<CTreeNode>();
+    auto* leakedSampled = sampled.get();
+    sampled->child      = unsampled;
+    unsampled->child    = sampled;
+    sampled.reset();
+    unsampled.reset();
+    EXPECT_EQ(Tracker::findCycles().size(), CYCLESBEFORE + 1);
+
+    leakedFirst->child.reset();
+    leakedSampled->child.reset();
+    EXPECT_EQ(Tracker::findCycles().size(), CYCLESBEFORE);
+
+    // a block only spans its static type: handed over as the base, the derived part's pointers are not seen
+    auto  derived     = makeShared<CDerivedNode>();
+    auto* leakedFused = derived.get();
+    derived->next     = derived;
+    derived.reset();
+    ASSERT_EQ(Tracker::findCycles().size(), CYCLESBEFORE + 1);
+
+    auto* raw        = new CDerivedNode();
+    auto  base       = CSharedPointer<CBaseNode>(raw);
+    raw->next        = base;
+    base.reset();
+    EXPECT_EQ(Tracker::findCycles().size(), CYCLESBEFORE + 1);
+
+    leakedFused->next.reset();
+    raw->next.reset();
+    EXPECT_EQ(Tracker::findCycles().size(), CYCLESBEFORE);
+
+    // a ring far longer than the stack could take recursively
+    std::vector<CSharedPointer<CTreeNode>> ring(100000);
+    std::vector<CWeakPointer<CTreeNode>>   weakRing;
+    for (auto& node : ring) {
+        node = makeShared<CTreeNode>();
+        weakRing.emplace_back(node);
+    }
+
+    for (size_t i = 0; i < ring.size(); ++i) {
+        ring[i]->child = ring[(i + 1) % ring.size()];
+    }
+
+    ring.clear();
+
+    const auto RINGCYCLES = Tracker::findCycles();
+    ASSERT_EQ(RINGCYCLES.size(), CYCLESBEFORE + 1);
+    EXPECT_TRUE(std::ranges::any_of(RINGCYCLES, [&](const auto& c) { return c.size() == weakRing.size(); }));
+
+    // and taken apart one by one, destroying it as a chain would recurse just the same
+    for (const auto& weak : weakRing) {
+        ring.emplace_back(weak.lock());
+    }
+
+    for (auto& node : ring) {
+        node->child.reset();
+    }
+}
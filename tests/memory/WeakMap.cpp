@@ -0,0 +1,75 @@
+#include <hyprutils/memory/WeakMap.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+TEST(Memory, weakMap) {
+    CWeakMap<int, std::string> map;
+
+    auto                       a = makeShared<int>(1);
+    auto                       b = makeShared<int>(2);
+
+    map[a] = "a";
+    EXPECT_TRUE(map.emplace(b, "b").second);
+    EXPECT_FALSE(map.emplace(b, "c").second);
+    EXPECT_EQ(*map.find(b), "b");
+    EXPECT_EQ(map.size(), 2);
+
+    // keyed on identity, not value
+    auto other = makeShared<int>(1);
+    EXPECT_EQ(map.find(other), nullptr);
+    EXPECT_TRUE(map.contains(CWeakPointer<int>(a)));
+
+    // an expired key can't be found anymore, and is gone once pruned
+    b.reset();
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(map.prune(), 1);
+    EXPECT_EQ(map.size(), 1);
+
+    EXPECT_TRUE(map.erase(a));
+    EXPECT_FALSE(map.erase(a));
+    EXPECT_TRUE(map.empty());
+
+    // lots of short-lived keys: the map must not grow with the dead ones
+    std::vector<CSharedPointer<int>> alive;
+    for (int i = 0; i < 100; ++i) {
+        alive.emplace_back(makeShared<int>(i));
+        map[alive.back()] = std::to_string(i);
+    }
+
+    for (int i = 0; i < 100000; ++i) {
+        auto temp = makeShared<int>(i);
+        map[temp] = "temp";
+    }
+
+    // sweeps before growing keep it at most a few times the live count
+    EXPECT_LE(map.size(), 1000);
+    map.prune();
+    EXPECT_EQ(map.size(), 100);
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_NE(map.find(alive[i]), nullptr);
+        EXPECT_EQ(*map.find(alive[i]), std::to_string(i));
+    }
+
+    size_t visited = 0;
+    map.forEach([&visited](const CWeakPointer<int>& key, std::string& value) {
+        EXPECT_EQ(std::to_string(*key), value);
+        visited++;
+    });
+    EXPECT_EQ(visited, 100);
+
+    // lookups evict whatever they probe past
+    alive.resize(50);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_NE(map.find(alive[i]), nullptr);
+    }
+
+    EXPECT_LE(map.size(), 100);
+    map.prune();
+    EXPECT_EQ(map.size(), 50);
+}
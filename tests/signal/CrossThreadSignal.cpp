@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <hyprutils/signal/CrossThreadSignal.hpp>
+#include <poll.h>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Signal;
+
+TEST(Signal, crossThreadSignal) {
+    constexpr int                 THREADS = 4;
+    constexpr int                 EMITS   = 10000;
+
+    CCrossThreadSignalT<int, int> signal(256);
+
+    long                          sum      = 0;
+    int                           received = 0;
+    auto                          listener = signal.listen([&](int thread, int value) {
+        sum += value;
+        received++;
+    });
+
+    std::vector<std::thread>      threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&signal, t]() {
+            for (int i = 0; i < EMITS; ++i) {
+                // the ring is small, wait for the owner to catch up
+                while (!signal.emit(t, i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    pollfd pfd = {.fd = signal.fd().get(), .events = POLLIN, .revents = 0};
+    while (received < THREADS * EMITS) {
+        if (poll(&pfd, 1, 1000) <= 0)
+            break;
+
+        signal.dispatchPending();
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    signal.dispatchPending();
+    EXPECT_EQ(received, THREADS * EMITS);
+    EXPECT_EQ(sum, THREADS * (long)EMITS * (EMITS - 1) / 2);
+
+    // nothing left, nothing to wake up for
+    EXPECT_EQ(signal.dispatchPending(), 0);
+    EXPECT_FALSE(signal.fd().isReadable());
+}
+
+TEST(Signal, crossThreadSignalFull) {
+    CCrossThreadSignalT<> signal(4);
+    int                   count    = 0;
+    auto                  listener = signal.listen([&] { count++; });
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(signal.emit());
+    }
+
+    EXPECT_FALSE(signal.emit());
+    EXPECT_TRUE(signal.fd().isReadable());
+
+    EXPECT_EQ(signal.dispatchPending(), 4);
+    EXPECT_EQ(count, 4);
+    EXPECT_TRUE(signal.emit());
+}
+
+TEST(Signal, crossThreadSignalInterleaved) {
+    constexpr int         EMITS = 200000;
+
+    CCrossThreadSignalT<> signal(4);
+    int                   received = 0;
+    std::atomic<bool>     stop     = false;
+    auto                  listener = signal.listen([&] { received++; });
+
+    // the ring is tiny, so emits keep landing while the owner clears the previous wakeup
+    std::thread producer([&] {
+        for (int i = 0; i < EMITS; ++i) {
+            while (!signal.emit()) {
+                if (stop)
+                    return;
+
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    pollfd pfd = {.fd = signal.fd().get(), .events = POLLIN, .revents = 0};
+    while (received < EMITS) {
+        // a lost wakeup leaves the fd unreadable with emits queued
+        if (poll(&pfd, 1, 1000) <= 0)
+            break;
+
+        signal.dispatchPending();
+    }
+
+    stop = true;
+    producer.join();
+
+    EXPECT_EQ(received, EMITS);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <hyprutils/signal/Signal.hpp>
+
+#include <cstddef>
+
+// a signal whose listener slots the tests can look at, stale ones included
+template <typename... Args>
+class CInspectableSignal : public Hyprutils::Signal::CSignalT<Args...> {
+  public:
+    size_t slots() const {
+        return this->m_vListeners.size();
+    }
+};
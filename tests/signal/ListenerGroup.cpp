@@ -0,0 +1,115 @@
+#include <hyprutils/signal/ListenerGroup.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+#include "InspectableSignal.hpp"
+
+#include <gtest/gtest.h>
+#include <array>
+
+using namespace Hyprutils::Signal;
+using namespace Hyprutils::Memory;
+
+TEST(Signal, listenerGroup) {
+    CInspectableSignal<int> signal;
+    CSignalT<>              other;
+
+    int                     sum   = 0;
+    int                     calls = 0;
+
+    CListenerGroup          group;
+    EXPECT_TRUE(group.empty());
+
+    group.listen(signal, [&sum](int v) { sum += v; });
+    group.listen(signal, [&calls] { calls++; });
+    group.listen(other, [&calls] { calls++; });
+
+    // priorities work like with any listener
+    std::vector<int> order;
+    group.listen(signal, [&order](int) { order.emplace_back(1); }, 1);
+    group.listen(signal, [&order](int) { order.emplace_back(2); }, 2);
+
+    EXPECT_EQ(group.size(), 5);
+
+    signal.emit(3);
+    other.emit();
+    EXPECT_EQ(sum, 3);
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(order, (std::vector<int>{2, 1}));
+
+    // a signal drops only its own entries
+    signal.disconnect(group);
+    EXPECT_EQ(signal.slots(), 0);
+
+    signal.emit(3);
+    other.emit();
+    EXPECT_EQ(sum, 3);
+    EXPECT_EQ(calls, 3);
+
+    group.clear();
+    EXPECT_TRUE(group.empty());
+
+    other.emit();
+    EXPECT_EQ(calls, 3);
+
+    // a cleared group can be reused
+    group.listen(other, [&calls] { calls += 10; });
+    other.emit();
+    EXPECT_EQ(calls, 13);
+}
+
+TEST(Signal, listenerGroupGrows) {
+    // what outlives a group while signals hold stale refs to it
+    static_assert(sizeof(Hyprutils::Signal::Impl_::CListenerArena) <= 512);
+
+    CSignalT<int> signal;
+    auto          alive = makeShared<int>(0);
+
+    int           sum = 0;
+    {
+        CListenerGroup group;
+
+        // well past the inline storage, with captures to destroy
+        for (int i = 0; i < 200; ++i) {
+            std::array<char, 48> padding{};
+            group.listen(signal, [&sum, alive, padding](int v) { sum += v + padding[0]; });
+        }
+
+        EXPECT_EQ(alive.strongRef(), 201);
+
+        signal.emit(1);
+        EXPECT_EQ(sum, 200);
+    }
+
+    // the captures died with the group
+    EXPECT_EQ(alive.strongRef(), 1);
+
+    signal.emit(1);
+    EXPECT_EQ(sum, 200);
+}
+
+TEST(Signal, listenerGroupClearedDuringEmit) {
+    CInspectableSignal<int> signal;
+    CListenerGroup          group;
+
+    int                     calls = 0;
+
+    group.listen(signal, [&](int) {
+        calls++;
+        group.clear();
+    });
+    group.listen(signal, [&calls](int) { calls++; });
+    auto regular = signal.listen([&calls](int) { calls += 10; });
+
+    signal.emit(0);
+    EXPECT_EQ(calls, 11);
+
+    // disconnecting during an emit empties the entries in place
+    group.listen(signal, [&](int) { signal.disconnect(group); });
+    group.listen(signal, [&calls](int) { calls++; });
+
+    signal.emit(0);
+    EXPECT_EQ(calls, 21);
+
+    signal.emit(0);
+    EXPECT_EQ(calls, 31);
+    EXPECT_EQ(signal.slots(), 1);
+}
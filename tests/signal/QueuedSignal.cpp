@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <hyprutils/signal/QueuedSignal.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Hyprutils::Signal;
+
+TEST(Signal, queuedSignal) {
+    std::vector<int>    delivered;
+
+    CQueuedSignalT<int> signal;
+    auto                listener = signal.listen([&](int value) { delivered.emplace_back(value); });
+
+    signal.emit(1);
+    signal.emit(2);
+    EXPECT_TRUE(delivered.empty());
+    EXPECT_EQ(signal.pending(), 2);
+
+    signal.flush();
+    EXPECT_EQ(delivered, (std::vector<int>{1, 2}));
+    EXPECT_EQ(signal.pending(), 0);
+
+    // emits from a listener go to the next flush
+    delivered.clear();
+    auto requeue = signal.listen([&](int value) {
+        if (value < 10)
+            signal.emit(value + 10);
+    });
+
+    signal.emit(3);
+    signal.flush();
+    EXPECT_EQ(delivered, (std::vector<int>{3}));
+    signal.flush();
+    EXPECT_EQ(delivered, (std::vector<int>{3, 13}));
+    requeue.reset();
+
+    // only the latest emit per key is delivered, in the place of the first
+    delivered.clear();
+    signal.coalesceBy([](int value) { return value % 2; });
+    signal.emit(1);
+    signal.emit(2);
+    signal.emit(3);
+    signal.emit(4);
+    signal.emit(5);
+    signal.flush();
+    EXPECT_EQ(delivered, (std::vector<int>{5, 4}));
+
+    delivered.clear();
+    signal.emit(1);
+    signal.emit(2);
+    signal.coalesceAll();
+    signal.emit(3);
+    signal.flush();
+    EXPECT_EQ(delivered, (std::vector<int>{3}));
+
+    signal.coalesceBy({});
+    signal.emit(1);
+    signal.emit(1);
+    signal.clear();
+    signal.flush();
+    EXPECT_EQ(delivered, (std::vector<int>{3}));
+}
+
+TEST(Signal, queuedSignalDestroyed) {
+    int  count = 0;
+
+    auto signal = std::make_unique<CQueuedSignalT<std::string>>();
+
+    auto listener = signal->listen([&](const std::string& value) {
+        count++;
+        if (value == "die")
+            signal.reset();
+    });
+
+    signal->emit("a");
+    signal->emit("die");
+    signal->emit("never");
+    signal->flush();
+    EXPECT_EQ(count, 2);
+}
@@ -6,6 +6,8 @@
 #include <hyprutils/signal/Listener.hpp>
 #include <hyprutils/memory/WeakPtr.hpp>
 #include <memory>
+#include <vector>
+#include "InspectableSignal.hpp"
 
 using namespace Hyprutils::Signal;
 using namespace Hyprutils::Memory;
@@ -117,6 +119,22 @@ static void typedMany() {
     EXPECT_EQ(data3, 3);
 }
 
+static void moveOnlyHandler() {
+    int           data = 0;
+
+    CSignalT<int> signal;
+    auto          owned    = std::make_unique<int>(2);
+    auto          listener = signal.listen([&data, owned = std::move(owned)](int newData) { data = newData * *owned; });
+
+    signal.listenStatic([&data, owned = std::make_unique<int>(3)] { data += *owned; });
+
+    // generic handlers take the args
+    auto generic = signal.listen([&data](auto... args) { data += sizeof...(args); });
+
+    signal.emit(5);
+    EXPECT_EQ(data, 14); // 5 * 2 + 1 + 3
+}
+
 static void ref() {
     int            count = 0;
     int            data  = 0;
@@ -303,6 +321,121 @@ static void signalDestroyedWithRemovedAndAddedListener() {
     EXPECT_EQ(count, 0);
 }
 
+static void signalDestroyedInNestedEmit() {
+    int  count  = 0;
+    bool nested = false;
+
+    auto signal = std::make_unique<CSignalT<>>();
+
+    auto first = signal->listen([&] {
+        if (nested)
+            return;
+
+        nested = true;
+        signal->emit();
+    });
+
+    auto second = signal->listen([&] { signal.reset(); });
+    auto third  = signal->listen([&] { count += 1; });
+
+    signal->emit();
+    EXPECT_EQ(count, 2); // the nested emit and the one it's nested in both carry on
+}
+
+static void signalCopied() {
+    int        count = 0;
+
+    CSignalT<> signal;
+    auto       listener = signal.listen([&] { count += 1; });
+
+    CSignalT<> copy = signal;
+    copy.emit();
+    signal.emit();
+    EXPECT_EQ(count, 2);
+}
+
+static void manyShortLivedListeners() {
+    int                              count = 0;
+
+    CInspectableSignal<>             signal;
+    std::vector<CHyprSignalListener> alive;
+
+    for (int i = 0; i < 100000; ++i) {
+        auto listener = signal.listen([&] { count += 1; });
+        if (i % 1000 == 0)
+            alive.emplace_back(listener);
+    }
+
+    // stale ones get swept, but not on every listen
+    EXPECT_LE(signal.slots(), 4 * alive.size() + 16);
+
+    signal.emit();
+    EXPECT_EQ(count, 100);
+
+    // an emit that walks mostly stale entries sweeps them
+    alive.resize(10);
+    signal.emit();
+    EXPECT_EQ(count, 110);
+    EXPECT_EQ(signal.slots(), 10);
+
+    // dropped right away, they never pile up at the back
+    for (int i = 0; i < 1000; ++i) {
+        auto listener = signal.listen([&] { count += 1; });
+    }
+
+    EXPECT_EQ(signal.slots(), 11);
+}
+
+static void priorities() {
+    std::vector<int>    order;
+
+    CSignalT<>          signal;
+    CHyprSignalListener late;
+
+    auto                low    = signal.listen([&] { order.emplace_back(-1); }, -1);
+    auto                normal = signal.listen([&] {
+        order.emplace_back(0);
+
+        // runs from the next emit on, in its place
+        if (!late)
+            late = signal.listen([&] { order.emplace_back(5); }, 5);
+    });
+    auto                high   = signal.listen([&] { order.emplace_back(10); }, 10);
+
+    signal.listenStatic([&] { order.emplace_back(1); }, 1);
+    signal.listenStatic([&] { order.emplace_back(100); }, 100);
+
+    signal.emit();
+    EXPECT_EQ(order, (std::vector<int>{100, 10, 1, 0, -1}));
+
+    order.clear();
+    signal.emit();
+    EXPECT_EQ(order, (std::vector<int>{100, 10, 5, 1, 0, -1}));
+}
+
+static void consumable() {
+    int                     seen = 0;
+
+    CConsumableSignalT<int> signal;
+
+    auto                    observer = signal.listen([&](int) { seen++; }, 10);
+    auto                    consumer = signal.listen([&](int value) { return value > 0; });
+    auto                    fallback = signal.listen([&](int) { seen += 100; }, -10);
+
+    EXPECT_TRUE(signal.emit(1));
+    EXPECT_EQ(seen, 1);
+
+    EXPECT_FALSE(signal.emit(0));
+    EXPECT_EQ(seen, 102);
+
+    // a plain signal never stops
+    CSignalT<> plain;
+    auto       first  = plain.listen([&] { return true; });
+    auto       second = plain.listen([&] { seen++; });
+    plain.emit();
+    EXPECT_EQ(seen, 103);
+}
+
 static void staticListener() {
     int           data = 0;
 
@@ -344,6 +477,37 @@ static void listenerDestroysSelf() {
     signal.emit();
 }
 
+static void handlerThrows() {
+    std::vector<int> order;
+
+    auto             signal = std::make_unique<CSignalT<>>();
+
+    auto             thrower = signal->listen([] { throw 1; });
+    EXPECT_THROW(signal->emit(), int);
+    thrower.reset();
+
+    // the signal is done emitting, these go straight into place
+    auto low  = signal->listen([&] { order.emplace_back(0); }, 0);
+    auto high = signal->listen([&] { order.emplace_back(10); }, 10);
+
+    signal->emit();
+    signal->emit();
+    EXPECT_EQ(order, (std::vector<int>{10, 0, 10, 0}));
+
+    // out of a nested emit, both frames are let go of
+    bool nested = false;
+    auto nester = signal->listen([&] {
+        if (nested)
+            throw 1;
+
+        nested = true;
+        signal->emit();
+    }, 5);
+    EXPECT_THROW(signal->emit(), int);
+
+    signal.reset();
+}
+
 TEST(Signal, signal) {
     legacy();
     legacyListenerEmit();
@@ -352,6 +516,7 @@ TEST(Signal, signal) {
     typed();
     ignoreParams();
     typedMany();
+    moveOnlyHandler();
     ref();
     refMany();
     autoRefTypes();
@@ -362,8 +527,14 @@ TEST(Signal, signal) {
     signalDestroyedBeforeListener();
     signalDestroyedWithAddedListener();
     signalDestroyedWithRemovedAndAddedListener();
+    signalDestroyedInNestedEmit();
+    signalCopied();
+    manyShortLivedListeners();
+    priorities();
+    consumable();
     staticListener();
     staticListenerDestroy();
     signalDestroyed();
     listenerDestroysSelf();
+    handlerThrows();
 }
\ No newline at end of file
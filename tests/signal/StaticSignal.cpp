@@ -0,0 +1,52 @@
+#include <hyprutils/signal/StaticSignal.hpp>
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace Hyprutils::Signal;
+
+namespace {
+    class CCounter {
+      public:
+        void add(int v) {
+            sum += v;
+            log.emplace_back("add");
+        }
+
+        void addTwice(const int& v) {
+            sum += v * 2;
+            log.emplace_back("addTwice");
+        }
+
+        int                      sum = 0;
+        std::vector<std::string> log;
+    };
+
+    void record(CCounter* counter, int v) {
+        counter->log.emplace_back("record " + std::to_string(v));
+    }
+
+    void consume(CCounter* counter, std::string s) {
+        counter->log.emplace_back(std::move(s));
+    }
+}
+
+TEST(Signal, staticSignal) {
+    CCounter                                                               counter;
+    CStaticSignalT<CCounter, &CCounter::add, &record, &CCounter::addTwice> signal(&counter);
+    const CStaticSignalT<CCounter, &consume, &consume>                     strings(&counter);
+    CStaticSignalT<CCounter>                                               empty(&counter);
+
+    signal.emit(3);
+    EXPECT_EQ(counter.sum, 9);
+    EXPECT_EQ(counter.log, (std::vector<std::string>{"add", "record 3", "addTwice"}));
+
+    // a handler taking by value can't move the args away from the next one
+    counter.log.clear();
+    strings.emit(std::string("a long enough string to not be small"));
+    EXPECT_EQ(counter.log, (std::vector<std::string>{"a long enough string to not be small", "a long enough string to not be small"}));
+
+    empty.emit();
+    empty.emit(1, 2);
+}
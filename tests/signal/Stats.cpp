@@ -0,0 +1,92 @@
+#include <hyprutils/signal/Signal.hpp>
+#include <hyprutils/signal/Stats.hpp>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+using namespace Hyprutils::Signal;
+
+static SSignalStats statsFor(const std::string& name) {
+    const auto STATS = Stats::snapshot();
+    const auto IT    = std::ranges::find(STATS, name, &SSignalStats::name);
+    return IT == STATS.end() ? SSignalStats{} : *IT;
+}
+
+TEST(Signal, stats) {
+    if (!Stats::compiledIn())
+        GTEST_SKIP() << "built without HYPRUTILS_SIGNAL_STATS";
+
+    Stats::setSampleRate(1);
+    Stats::reset();
+
+    CSignalT<int> signal;
+    signal.setName("test.stats");
+
+    // counted without any listeners too
+    signal.emit(1);
+    EXPECT_EQ(statsFor("test.stats").emits, 1);
+    EXPECT_EQ(statsFor("test.stats").listeners, 0);
+
+    int  sum = 0;
+    auto l1  = signal.listen([&sum](int v) { sum += v; });
+    auto l2  = signal.listen([&sum](int v) { sum += v; });
+    signal.listenStatic([&sum](int v) { sum += v; });
+
+    signal.emit(2);
+    EXPECT_EQ(sum, 6);
+
+    auto stats = statsFor("test.stats");
+    EXPECT_EQ(stats.emits, 2);
+    EXPECT_EQ(stats.timedEmits, 2);
+    EXPECT_EQ(stats.listeners, 3);
+    EXPECT_GE(stats.totalDispatch, stats.maxDispatch);
+
+    // signals with the same name add up
+    CSignalT<int> other;
+    other.setName("test.stats");
+    l2.reset();
+    other.emit(3);
+    signal.emit(4);
+
+    stats = statsFor("test.stats");
+    EXPECT_EQ(stats.emits, 4);
+    EXPECT_EQ(stats.listeners, 2);
+
+    // counts stay exact, only timing is sampled
+    Stats::setSampleRate(0);
+    signal.emit(5);
+    stats = statsFor("test.stats");
+    EXPECT_EQ(stats.emits, 5);
+    EXPECT_EQ(stats.timedEmits, 4);
+
+    Stats::setSampleRate(1);
+
+    // unnamed signals are not recorded
+    CSignalT<int> unnamed;
+    const auto    BEFORE = Stats::snapshot().size();
+    unnamed.emit(6);
+    EXPECT_EQ(Stats::snapshot().size(), BEFORE);
+
+    Stats::reset();
+    EXPECT_EQ(statsFor("test.stats").emits, 0);
+}
+
+TEST(Signal, statsSignalDiesDuringEmit) {
+    if (!Stats::compiledIn())
+        GTEST_SKIP() << "built without HYPRUTILS_SIGNAL_STATS";
+
+    Stats::setSampleRate(1);
+    Stats::reset();
+
+    auto* signal = new CSignalT<>();
+    signal->setName("test.statsDies");
+    signal->listenStatic([&signal] {
+        delete signal;
+        signal = nullptr;
+    });
+
+    signal->emit();
+    EXPECT_EQ(signal, nullptr);
+    EXPECT_EQ(statsFor("test.statsDies").emits, 1);
+    EXPECT_EQ(statsFor("test.statsDies").timedEmits, 1);
+}